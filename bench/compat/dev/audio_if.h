@@ -0,0 +1,18 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_DEV_AUDIO_IF_H
+#define _KMIXER_COMPAT_DEV_AUDIO_IF_H
+
+#include <sys/types.h>
+
+#define AUDIO_MAX_CHANNELS	12
+
+typedef struct audio_params {
+	u_int	sample_rate;
+	u_int	encoding;
+	u_int	precision;
+	u_int	validbits;
+	u_int	channels;
+} audio_params_t;
+
+#endif /* !_KMIXER_COMPAT_DEV_AUDIO_IF_H */
@@ -0,0 +1,39 @@
+/* $NetBSD$ */
+
+/*
+ * Definitions the kernel sources expect from the NetBSD kernel
+ * environment, for building them as ordinary userland objects.
+ * Included ahead of every source file by the Makefile.
+ */
+
+#ifndef _KMIXER_COMPAT_H
+#define _KMIXER_COMPAT_H
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define __KERNEL_RCSID(n, s)	\
+	static const char __unused_rcsid_##n[] __attribute__((__unused__)) = s
+
+#define CTASSERT(x)	_Static_assert(x, #x)
+
+#ifndef __arraycount
+#define __arraycount(a)	(sizeof(a) / sizeof((a)[0]))
+#endif
+
+#ifndef MIN
+#define MIN(a, b)	((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)	((a) > (b) ? (a) : (b))
+#endif
+#ifndef howmany
+#define howmany(x, y)	(((x) + ((y) - 1)) / (y))
+#endif
+
+#ifndef NBBY
+#define NBBY	8
+#endif
+
+#endif /* !_KMIXER_COMPAT_H */
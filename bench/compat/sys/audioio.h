@@ -0,0 +1,22 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_SYS_AUDIOIO_H
+#define _KMIXER_COMPAT_SYS_AUDIOIO_H
+
+/* values match NetBSD <sys/audioio.h> */
+#define AUDIO_ENCODING_NONE		0
+#define AUDIO_ENCODING_ULAW		1
+#define AUDIO_ENCODING_ALAW		2
+#define AUDIO_ENCODING_PCM16		3
+#define AUDIO_ENCODING_LINEAR		AUDIO_ENCODING_PCM16
+#define AUDIO_ENCODING_PCM8		4
+#define AUDIO_ENCODING_LINEAR8		AUDIO_ENCODING_PCM8
+#define AUDIO_ENCODING_ADPCM		5
+#define AUDIO_ENCODING_SLINEAR_LE	6
+#define AUDIO_ENCODING_SLINEAR_BE	7
+#define AUDIO_ENCODING_ULINEAR_LE	8
+#define AUDIO_ENCODING_ULINEAR_BE	9
+#define AUDIO_ENCODING_SLINEAR		10
+#define AUDIO_ENCODING_ULINEAR		11
+
+#endif /* !_KMIXER_COMPAT_SYS_AUDIOIO_H */
@@ -0,0 +1,14 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_SYS_BITOPS_H
+#define _KMIXER_COMPAT_SYS_BITOPS_H
+
+#include <stdint.h>
+
+static inline int
+fls32(uint32_t x)
+{
+	return x == 0 ? 0 : 32 - __builtin_clz(x);
+}
+
+#endif /* !_KMIXER_COMPAT_SYS_BITOPS_H */
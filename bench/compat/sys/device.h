@@ -0,0 +1,3 @@
+/* $NetBSD$ */
+
+/* Nothing the converter needs from autoconf. */
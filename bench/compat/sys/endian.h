@@ -0,0 +1,81 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_SYS_ENDIAN_H
+#define _KMIXER_COMPAT_SYS_ENDIAN_H
+
+#include <endian.h>
+#include <stdint.h>
+
+static inline uint16_t
+le16dec(const void *buf)
+{
+	const uint8_t *p = buf;
+
+	return p[0] | (p[1] << 8);
+}
+
+static inline uint16_t
+be16dec(const void *buf)
+{
+	const uint8_t *p = buf;
+
+	return (p[0] << 8) | p[1];
+}
+
+static inline void
+le16enc(void *buf, uint16_t v)
+{
+	uint8_t *p = buf;
+
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static inline void
+be16enc(void *buf, uint16_t v)
+{
+	uint8_t *p = buf;
+
+	p[0] = v >> 8;
+	p[1] = v;
+}
+
+static inline uint32_t
+le32dec(const void *buf)
+{
+	const uint8_t *p = buf;
+
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint32_t
+be32dec(const void *buf)
+{
+	const uint8_t *p = buf;
+
+	return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static inline void
+le32enc(void *buf, uint32_t v)
+{
+	uint8_t *p = buf;
+
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+static inline void
+be32enc(void *buf, uint32_t v)
+{
+	uint8_t *p = buf;
+
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+#endif /* !_KMIXER_COMPAT_SYS_ENDIAN_H */
@@ -0,0 +1,8 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_SYS_IOCCOM_H
+#define _KMIXER_COMPAT_SYS_IOCCOM_H
+
+#include <sys/ioctl.h>
+
+#endif /* !_KMIXER_COMPAT_SYS_IOCCOM_H */
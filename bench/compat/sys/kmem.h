@@ -0,0 +1,37 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_SYS_KMEM_H
+#define _KMIXER_COMPAT_SYS_KMEM_H
+
+#include <stdlib.h>
+
+#define KM_SLEEP	0x01
+#define KM_NOSLEEP	0x02
+
+static inline void *
+kmem_alloc(size_t size, int flags)
+{
+	void *p;
+
+	if ((p = malloc(size)) == NULL)
+		abort();
+	return p;
+}
+
+static inline void *
+kmem_zalloc(size_t size, int flags)
+{
+	void *p;
+
+	if ((p = calloc(1, size)) == NULL)
+		abort();
+	return p;
+}
+
+static inline void
+kmem_free(void *p, size_t size)
+{
+	free(p);
+}
+
+#endif /* !_KMIXER_COMPAT_SYS_KMEM_H */
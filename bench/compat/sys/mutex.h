@@ -0,0 +1,23 @@
+/* $NetBSD$ */
+
+/*
+ * The benchmark is single threaded, so locks only need to compile.
+ */
+
+#ifndef _KMIXER_COMPAT_SYS_MUTEX_H
+#define _KMIXER_COMPAT_SYS_MUTEX_H
+
+typedef struct {
+	int	mtx_owned;
+} kmutex_t;
+
+#define MUTEX_DEFAULT	0
+#define IPL_NONE	0
+
+#define mutex_init(m, t, ipl)	((m)->mtx_owned = 0)
+#define mutex_destroy(m)	((void)(m))
+#define mutex_enter(m)		((m)->mtx_owned = 1)
+#define mutex_exit(m)		((m)->mtx_owned = 0)
+#define mutex_owned(m)		((m)->mtx_owned)
+
+#endif /* !_KMIXER_COMPAT_SYS_MUTEX_H */
@@ -0,0 +1,12 @@
+/* $NetBSD$ */
+
+#ifndef _KMIXER_COMPAT_SYS_SYSTM_H
+#define _KMIXER_COMPAT_SYS_SYSTM_H
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define KASSERT(e)	assert(e)
+
+#endif /* !_KMIXER_COMPAT_SYS_SYSTM_H */
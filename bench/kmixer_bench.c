@@ -0,0 +1,710 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Userland microbenchmark for the kmixer sample converter and mix bus.
+ *
+ * Every converter kernel is run over a synthetic signal in 10ms chunks,
+ * the way the mixer calls it, at each converter quality, and reported as
+ * source frames per second and nanoseconds per source frame.
+ *
+ * usage: kmixer_bench [-c] [-i isa] [-t msec] [pattern ...]
+ *
+ * Only benchmarks whose name contains one of the patterns are run.  -i
+ * forces a vector kernel set (scalar, sse2, avx2, neon) instead of the
+ * best one the CPU supports.  -c checks instead of timing: every vector
+ * kernel set the CPU supports must match the scalar one bit for bit,
+ * and the exit status is 1 if one does not.
+ */
+
+#include <sys/types.h>
+#include <sys/audioio.h>
+
+#include <dev/audio_if.h>
+
+#include <err.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "kmixer_samplerate.h"
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+#include "kmixerio.h"
+
+#define BENCH_CHUNK_MS	10
+#define BENCH_RINGFRAMES	8192
+
+enum bench_dir { BENCH_PLAY, BENCH_RECORD };
+
+static const struct {
+	const char	*name;
+	u_int		src, dst;
+} bench_rates[] = {
+	{ "up",		44100, 48000 },
+	{ "down",	48000, 44100 },
+	{ "equal",	48000, 48000 },
+};
+
+static const struct {
+	u_int		src, dst;
+} bench_chans[] = {
+	{ 1, 2 },
+	{ 2, 1 },
+	{ 2, 2 },
+};
+
+static const struct {
+	const char	*name;
+	u_int		encoding;
+	u_int		precision;
+} bench_fmts[] = {
+	{ "s16le",	AUDIO_ENCODING_SLINEAR_LE,	16 },
+	{ "s16be",	AUDIO_ENCODING_SLINEAR_BE,	16 },
+	{ "s24le",	AUDIO_ENCODING_SLINEAR_LE,	24 },
+	{ "s24be",	AUDIO_ENCODING_SLINEAR_BE,	24 },
+	{ "s32le",	AUDIO_ENCODING_SLINEAR_LE,	32 },
+	{ "s32be",	AUDIO_ENCODING_SLINEAR_BE,	32 },
+	{ "f32le",	KMIXER_ENCODING_FLOAT_LE,	32 },
+	{ "f32be",	KMIXER_ENCODING_FLOAT_BE,	32 },
+};
+
+static const struct {
+	const char	*name;
+	int		quality;
+} bench_quals[] = {
+	{ "linear",	KMIXER_SAMPLERATE_LINEAR },
+	{ "short",	KMIXER_SAMPLERATE_SHORT },
+	{ "long",	KMIXER_SAMPLERATE_LONG },
+};
+
+/* vector kernel sets to hold against kmixer_simd_scalar */
+static const char * const bench_isas[] = {
+	"sse2",
+	"avx2",
+	"neon",
+};
+
+#define BENCH_CHECK_MAX	1024	/* longest run checked, in samples */
+
+static long bench_msec = 200;
+static char **bench_patterns;
+static int bench_npatterns;
+
+static double
+bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int
+bench_selected(const char *name)
+{
+	int i;
+
+	if (bench_npatterns == 0)
+		return 1;
+	for (i = 0; i < bench_npatterns; i++)
+		if (strstr(name, bench_patterns[i]) != NULL)
+			return 1;
+	return 0;
+}
+
+static void
+bench_report(const char *name, double frames, double secs)
+{
+	printf("%-40s %12.0f %10.2f\n", name, frames / secs,
+	    secs * 1e9 / frames);
+}
+
+/*
+ * Fill a buffer with a full scale two-tone signal in format p.
+ */
+static void
+bench_fill(uint8_t *buf, size_t nframes, const struct audio_params *p)
+{
+	const u_int bps = p->precision / NBBY;
+	const int le = p->encoding == AUDIO_ENCODING_SLINEAR_LE ||
+	    p->encoding == KMIXER_ENCODING_FLOAT_LE;
+	double phase, x;
+	float f;
+	int32_t v;
+	size_t i;
+	u_int c, b;
+
+	for (i = 0; i < nframes; i++) {
+		for (c = 0; c < p->channels; c++) {
+			phase = 2 * M_PI * i * (440.0 + 110.0 * c) /
+			    p->sample_rate;
+			x = 0.45 * (sin(phase) + sin(phase * 3.01));
+			if (p->encoding == KMIXER_ENCODING_FLOAT_LE ||
+			    p->encoding == KMIXER_ENCODING_FLOAT_BE) {
+				f = x;
+				memcpy(&v, &f, sizeof(v));
+			} else
+				v = (int32_t)(x *
+				    ((1u << (p->precision - 1)) - 1));
+			for (b = 0; b < bps; b++) {
+				if (le)
+					*buf++ = v >> (8 * b);
+				else
+					*buf++ = v >> (8 * (bps - 1 - b));
+			}
+		}
+	}
+}
+
+static void
+bench_convert(enum bench_dir dir, u_int fmtidx, u_int rateidx, u_int chidx,
+    u_int qualidx)
+{
+	struct kmixer_samplerate_context ctx;
+	struct audio_params client, hw, *src, *dst;
+	uint8_t *sbuf, *dbuf, *ring, *r;
+	size_t sfsize, dfsize, ringsize, chunk, sbufsize, dbufsize;
+	double start, now, frames;
+	char name[64];
+	int i, n;
+
+	memset(&client, 0, sizeof(client));
+	memset(&hw, 0, sizeof(hw));
+	client.encoding = hw.encoding = bench_fmts[fmtidx].encoding;
+	client.precision = hw.precision = bench_fmts[fmtidx].precision;
+	client.validbits = hw.validbits = bench_fmts[fmtidx].precision;
+
+	/* the converter's "from" is always the client, "to" the hardware */
+	if (dir == BENCH_PLAY) {
+		src = &client;
+		dst = &hw;
+	} else {
+		src = &hw;
+		dst = &client;
+	}
+	src->sample_rate = bench_rates[rateidx].src;
+	dst->sample_rate = bench_rates[rateidx].dst;
+	src->channels = bench_chans[chidx].src;
+	dst->channels = bench_chans[chidx].dst;
+
+	/* quality only matters when the rate changes */
+	if (src->sample_rate == dst->sample_rate && qualidx > 0)
+		return;
+	snprintf(name, sizeof(name), "%s %s %s %u->%u%s%s",
+	    dir == BENCH_PLAY ? "play" : "record",
+	    bench_fmts[fmtidx].name, bench_rates[rateidx].name,
+	    src->channels, dst->channels,
+	    src->sample_rate == dst->sample_rate ? "" : " ",
+	    src->sample_rate == dst->sample_rate ? "" :
+	    bench_quals[qualidx].name);
+	if (!bench_selected(name))
+		return;
+	if (kmixer_samplerate_check_params(&client, &hw) != 0) {
+		printf("%-40s %12s\n", name, "unsupported");
+		return;
+	}
+
+	sfsize = src->channels * src->precision / NBBY;
+	dfsize = dst->channels * dst->precision / NBBY;
+	chunk = src->sample_rate * BENCH_CHUNK_MS / 1000;
+
+	/* play writes into a ring, record reads from one */
+	if (dir == BENCH_PLAY) {
+		ringsize = BENCH_RINGFRAMES * dfsize;
+		sbufsize = chunk * sfsize;
+		dbufsize = ringsize;
+	} else {
+		ringsize = BENCH_RINGFRAMES * sfsize;
+		sbufsize = ringsize;
+		dbufsize = (chunk * dst->sample_rate / src->sample_rate + 2) *
+		    dfsize;
+	}
+	sbuf = malloc(sbufsize);
+	dbuf = malloc(dbufsize);
+	if (sbuf == NULL || dbuf == NULL)
+		err(1, "malloc");
+	bench_fill(sbuf, sbufsize / sfsize, src);
+
+	ring = dir == BENCH_PLAY ? dbuf : sbuf;
+	if (kmixer_samplerate_init_context(&ctx, src, dst,
+	    bench_quals[qualidx].quality, false, ring, ring + ringsize) != 0)
+		errx(1, "%s: can't initialise context", name);
+
+	r = ring;
+	frames = 0;
+	start = bench_now();
+	do {
+		for (i = 0; i < 64; i++) {
+			if (dir == BENCH_PLAY) {
+				n = kmixer_samplerate_play(&ctx, r, sbuf,
+				    chunk * sfsize);
+				r = ring + (r - ring + n) % ringsize;
+			} else {
+				kmixer_samplerate_record(&ctx, dbuf, r,
+				    chunk * sfsize);
+				r = ring + (r - ring + chunk * sfsize) %
+				    ringsize;
+			}
+		}
+		frames += 64.0 * chunk;
+		now = bench_now();
+	} while ((now - start) * 1000 < bench_msec);
+
+	bench_report(name, frames, now - start);
+
+	kmixer_samplerate_destroy_context(&ctx);
+	free(sbuf);
+	free(dbuf);
+}
+
+static void
+bench_mix(u_int fmtidx)
+{
+	struct audio_params p;
+	struct kmixer_ramp ramp;
+	struct kmixer_dither dither;
+	uint8_t *buf;
+	int32_t *bus;
+	double start, now, frames;
+	char name[64];
+	size_t nsamples;
+	int i, shape;
+
+	memset(&p, 0, sizeof(p));
+	p.sample_rate = 48000;
+	p.encoding = bench_fmts[fmtidx].encoding;
+	p.precision = p.validbits = bench_fmts[fmtidx].precision;
+	p.channels = 2;
+	nsamples = p.sample_rate * BENCH_CHUNK_MS / 1000 * p.channels;
+
+	buf = malloc(nsamples * p.precision / NBBY);
+	bus = calloc(nsamples, sizeof(*bus));
+	if (buf == NULL || bus == NULL)
+		err(1, "malloc");
+	bench_fill(buf, nsamples / p.channels, &p);
+
+	snprintf(name, sizeof(name), "mix add %s 2ch",
+	    bench_fmts[fmtidx].name);
+	if (bench_selected(name)) {
+		frames = 0;
+		start = bench_now();
+		do {
+			for (i = 0; i < 64; i++) {
+				memset(bus, 0, nsamples * sizeof(*bus));
+				kmixer_mix_add(bus, buf, &p, nsamples);
+			}
+			frames += 64.0 * nsamples / p.channels;
+			now = bench_now();
+		} while ((now - start) * 1000 < bench_msec);
+		bench_report(name, frames, now - start);
+	}
+
+	/* a panned gain, so the scaling loop rather than mix add runs */
+	snprintf(name, sizeof(name), "mix gain %s 2ch",
+	    bench_fmts[fmtidx].name);
+	if (bench_selected(name)) {
+		memset(&ramp, 0, sizeof(ramp));
+		ramp.r_gain[0] = KMIXER_MIX_UNITY / 2;
+		ramp.r_gain[1] = KMIXER_MIX_UNITY;
+		frames = 0;
+		start = bench_now();
+		do {
+			for (i = 0; i < 64; i++) {
+				memset(bus, 0, nsamples * sizeof(*bus));
+				kmixer_mix_add_gain(bus, buf, &p,
+				    nsamples / p.channels, &ramp);
+			}
+			frames += 64.0 * nsamples / p.channels;
+			now = bench_now();
+		} while ((now - start) * 1000 < bench_msec);
+		bench_report(name, frames, now - start);
+	}
+
+	/* odd bus values, which no period of 16-bit clients would leave */
+	for (shape = 0; shape < 2; shape++) {
+		snprintf(name, sizeof(name), "mix %s %s 2ch",
+		    shape ? "shaped" : "dither", bench_fmts[fmtidx].name);
+		if (p.precision >= KMIXER_BUS_BITS || !bench_selected(name))
+			continue;
+		kmixer_mix_dither_init(&dither, 1);
+		dither.d_shape = shape;
+		frames = 0;
+		start = bench_now();
+		do {
+			for (i = 0; i < 64; i++) {
+				bus[0] |= 1;
+				kmixer_mix_dither(bus, &p, nsamples, &dither);
+			}
+			frames += 64.0 * nsamples / p.channels;
+			now = bench_now();
+		} while ((now - start) * 1000 < bench_msec);
+		bench_report(name, frames, now - start);
+	}
+
+	snprintf(name, sizeof(name), "mix out %s 2ch",
+	    bench_fmts[fmtidx].name);
+	if (bench_selected(name)) {
+		frames = 0;
+		start = bench_now();
+		do {
+			for (i = 0; i < 64; i++)
+				kmixer_mix_out(buf, bus, &p, nsamples);
+			frames += 64.0 * nsamples / p.channels;
+			now = bench_now();
+		} while ((now - start) * 1000 < bench_msec);
+		bench_report(name, frames, now - start);
+	}
+
+	free(buf);
+	free(bus);
+}
+
+/*
+ * Random samples, a few of them at or past the ends of the int32_t
+ * range so that saturation is exercised too.
+ */
+static void
+bench_random(int32_t *v, u_int n)
+{
+	u_int i;
+
+	for (i = 0; i < n; i++) {
+		switch (random() % 16) {
+		case 0:
+			v[i] = INT32_MAX - random() % 4;
+			break;
+		case 1:
+			v[i] = INT32_MIN + random() % 4;
+			break;
+		default:
+			v[i] = (int32_t)((uint32_t)random() << 1 ^ random());
+			break;
+		}
+	}
+}
+
+static int
+bench_check_fail(const char *isa, const char *op, u_int n)
+{
+	printf("%-8s %-12s mismatch, %u samples\n", isa, op, n);
+	return 1;
+}
+
+/*
+ * Run the selected kernel set and the scalar one on the same random
+ * input at every length up to 69 and a few longer, and compare.  The
+ * dither generators are carried from one length to the next so that
+ * lanes left part way through a block are covered.
+ */
+static int
+bench_check_simd(const char *isa)
+{
+	static const u_int longer[] = { 255, 256, 257, 1000, BENCH_CHECK_MAX };
+	const struct kmixer_simd_ops *s = &kmixer_simd_scalar;
+	static int32_t in[BENCH_CHECK_MAX], a[BENCH_CHECK_MAX],
+	    b[BENCH_CHECK_MAX];
+	static int16_t src[2 * BENCH_CHECK_MAX], c[2 * BENCH_CHECK_MAX],
+	    d[2 * BENCH_CHECK_MAX];
+	uint32_t sa[KMIXER_DITHER_LANES], sb[KMIXER_DITHER_LANES];
+	struct kmixer_dither dither;
+	u_int i, k, n;
+	int fail = 0;
+
+	kmixer_mix_dither_init(&dither, 1);
+	memcpy(sa, dither.d_seed, sizeof(sa));
+	memcpy(sb, dither.d_seed, sizeof(sb));
+	for (k = 0; k < 70 + __arraycount(longer); k++) {
+		n = k < 70 ? k : longer[k - 70];
+
+		/* n frames of stereo 16-bit, then n bus samples */
+		bench_random(a, n);
+		memcpy(src, a, 2 * n * sizeof(*src));
+		bench_random(in, n);
+
+		memcpy(a, in, n * sizeof(*a));
+		memcpy(b, in, n * sizeof(*b));
+		s->mix_add_s16(a, src, n);
+		kmixer_simd_mix_add_s16(b, src, n);
+		if (memcmp(a, b, n * sizeof(*a)) != 0)
+			fail |= bench_check_fail(isa, "mix_add_s16", n);
+
+		s->mix_out_s16(c, in, n);
+		kmixer_simd_mix_out_s16(d, in, n);
+		if (memcmp(c, d, n * sizeof(*c)) != 0)
+			fail |= bench_check_fail(isa, "mix_out_s16", n);
+
+		/* keep to the bus range plus some, as the mixer would */
+		for (i = 0; i < n; i++)
+			a[i] = b[i] = in[i] >> 6;
+		s->dither_s16(a, n, sa);
+		kmixer_simd_dither_s16(b, n, sb);
+		if (memcmp(a, b, n * sizeof(*a)) != 0 ||
+		    memcmp(sa, sb, sizeof(sa)) != 0)
+			fail |= bench_check_fail(isa, "dither_s16", n);
+
+		s->dup_s16(c, src, n);
+		kmixer_simd_dup_s16(d, src, n);
+		if (memcmp(c, d, 2 * n * sizeof(*c)) != 0)
+			fail |= bench_check_fail(isa, "dup_s16", n);
+
+		s->downmix_s16(c, src, n);
+		kmixer_simd_downmix_s16(d, src, n);
+		if (memcmp(c, d, n * sizeof(*c)) != 0)
+			fail |= bench_check_fail(isa, "downmix_s16", n);
+	}
+	return fail;
+}
+
+/*
+ * Write a sawtooth ramp of nframes frames in format p, little-endian
+ * whatever p says; bench_swap() makes a big-endian copy.
+ */
+static void
+bench_ramp(uint8_t *buf, size_t nframes, const struct audio_params *p)
+{
+	const u_int bps = p->precision / NBBY;
+	float f;
+	int32_t v;
+	size_t i;
+	u_int c, b;
+
+	for (i = 0; i < nframes; i++) {
+		for (c = 0; c < p->channels; c++) {
+			v = (int32_t)((i * 13 + c * 1000) % 4000) - 2000;
+			if (p->encoding == KMIXER_ENCODING_FLOAT_LE ||
+			    p->encoding == KMIXER_ENCODING_FLOAT_BE) {
+				f = v / 2048.0f;
+				memcpy(&v, &f, sizeof(v));
+			} else
+				v *= 1 << (p->precision - 12);
+			for (b = 0; b < bps; b++)
+				*buf++ = v >> (8 * b);
+		}
+	}
+}
+
+/* reverse the bytes of each bps byte sample */
+static void
+bench_swap(uint8_t *buf, size_t size, u_int bps)
+{
+	uint8_t t;
+	size_t i;
+	u_int b;
+
+	for (i = 0; i + bps <= size; i += bps) {
+		for (b = 0; b < bps / 2; b++) {
+			t = buf[i + b];
+			buf[i + b] = buf[i + bps - 1 - b];
+			buf[i + bps - 1 - b] = t;
+		}
+	}
+}
+
+/*
+ * Convert a ramp from src to dst in one call, with rings big enough
+ * not to wrap, and return the bytes written.
+ */
+static int
+bench_convert_once(enum bench_dir dir, const struct audio_params *src,
+    const struct audio_params *dst, int quality, uint8_t *in, size_t insize,
+    uint8_t *out, size_t outsize)
+{
+	struct kmixer_samplerate_context ctx;
+	int n;
+
+	if (kmixer_samplerate_init_context(&ctx, src, dst, quality, false,
+	    dir == BENCH_PLAY ? out : in,
+	    dir == BENCH_PLAY ? out + outsize : in + insize) != 0)
+		errx(1, "can't initialise context");
+	if (dir == BENCH_PLAY)
+		n = kmixer_samplerate_play(&ctx, out, in, insize);
+	else
+		n = kmixer_samplerate_record(&ctx, out, in, insize);
+	kmixer_samplerate_destroy_context(&ctx);
+	return n;
+}
+
+/*
+ * A big-endian format must convert to exactly the byte-swapped result
+ * of its little-endian twin, the entry before it in bench_fmts.
+ */
+static int
+bench_check_endian(enum bench_dir dir, u_int fmtidx, u_int rateidx,
+    u_int chidx, u_int qualidx)
+{
+	static uint8_t inle[BENCH_RINGFRAMES * 8], inbe[BENCH_RINGFRAMES * 8],
+	    outle[BENCH_RINGFRAMES * 8], outbe[BENCH_RINGFRAMES * 8];
+	const int quality = bench_quals[qualidx].quality;
+	struct audio_params client, hw, *src, *dst;
+	size_t insize;
+	u_int bps;
+	int n, m;
+
+	memset(&client, 0, sizeof(client));
+	client.encoding = bench_fmts[fmtidx].encoding;
+	client.precision = client.validbits = bench_fmts[fmtidx].precision;
+	hw = client;
+	if (dir == BENCH_PLAY) {
+		src = &client;
+		dst = &hw;
+	} else {
+		src = &hw;
+		dst = &client;
+	}
+	src->sample_rate = bench_rates[rateidx].src;
+	dst->sample_rate = bench_rates[rateidx].dst;
+	src->channels = bench_chans[chidx].src;
+	dst->channels = bench_chans[chidx].dst;
+	if (src->sample_rate == dst->sample_rate && qualidx > 0)
+		return 0;
+	if (kmixer_samplerate_check_params(&client, &hw) != 0)
+		return 0;
+
+	bps = src->precision / NBBY;
+	insize = BENCH_RINGFRAMES / 2 * src->channels * bps;
+	bench_ramp(inle, BENCH_RINGFRAMES / 2, src);
+	memcpy(inbe, inle, insize);
+	bench_swap(inbe, insize, bps);
+
+	m = bench_convert_once(dir, src, dst, quality, inbe, insize,
+	    outbe, sizeof(outbe));
+	bench_swap(outbe, m, bps);
+	src->encoding = dst->encoding = bench_fmts[fmtidx - 1].encoding;
+	n = bench_convert_once(dir, src, dst, quality, inle, insize,
+	    outle, sizeof(outle));
+	if (n == m && memcmp(outle, outbe, n) == 0)
+		return 0;
+
+	printf("%s %s %s %u->%u %s: differs from %s\n",
+	    dir == BENCH_PLAY ? "play" : "record", bench_fmts[fmtidx].name,
+	    bench_rates[rateidx].name, src->channels, dst->channels,
+	    bench_quals[qualidx].name, bench_fmts[fmtidx - 1].name);
+	return 1;
+}
+
+/*
+ * Check every vector kernel set built in and supported, or only isa,
+ * then the big-endian conversions.
+ */
+static int
+bench_check(const char *isa)
+{
+	u_int i, dir, f, r, c, q;
+	int error, fail = 0, efail = 0;
+
+	for (i = 0; i < __arraycount(bench_isas); i++) {
+		if (isa != NULL && strcmp(isa, bench_isas[i]) != 0)
+			continue;
+		error = kmixer_simd_select(bench_isas[i]);
+		if (error != 0) {
+			printf("%-8s %s\n", bench_isas[i],
+			    error == ENOENT ? "not built" : "unsupported");
+			continue;
+		}
+		srandom(1);
+		if (bench_check_simd(bench_isas[i]) != 0)
+			fail = 1;
+		else
+			printf("%-8s ok\n", bench_isas[i]);
+	}
+	kmixer_simd_init();
+	for (dir = BENCH_PLAY; dir <= BENCH_RECORD; dir++)
+	    for (f = 1; f < __arraycount(bench_fmts); f += 2)
+		for (r = 0; r < __arraycount(bench_rates); r++)
+		    for (c = 0; c < __arraycount(bench_chans); c++)
+			for (q = 0; q < __arraycount(bench_quals); q++)
+			    efail |= bench_check_endian(dir, f, r, c, q);
+	if (!efail)
+		printf("%-8s ok\n", "endian");
+	return fail | efail;
+}
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+	    "usage: kmixer_bench [-c] [-i isa] [-t msec] [pattern ...]\n");
+	exit(1);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const char *isa = NULL;
+	u_int dir, f, r, c, q;
+	int ch, error, check = 0;
+
+	while ((ch = getopt(argc, argv, "ci:t:")) != -1) {
+		switch (ch) {
+		case 'c':
+			check = 1;
+			break;
+		case 'i':
+			isa = optarg;
+			break;
+		case 't':
+			bench_msec = strtol(optarg, NULL, 10);
+			if (bench_msec <= 0)
+				usage();
+			break;
+		default:
+			usage();
+		}
+	}
+	bench_patterns = argv + optind;
+	bench_npatterns = argc - optind;
+
+	kmixer_samplerate_init();
+	kmixer_simd_init();
+	if (check) {
+		error = bench_check(isa);
+		kmixer_samplerate_fini();
+		return error;
+	}
+	if (isa != NULL && (error = kmixer_simd_select(isa)) != 0)
+		errx(1, "%s: %s", isa, strerror(error));
+
+	printf("simd: %s\n", kmixer_simd_name());
+	printf("%-40s %12s %10s\n", "kernel", "frames/s", "ns/frame");
+	for (dir = BENCH_PLAY; dir <= BENCH_RECORD; dir++)
+	    for (f = 0; f < __arraycount(bench_fmts); f++)
+		for (r = 0; r < __arraycount(bench_rates); r++)
+		    for (c = 0; c < __arraycount(bench_chans); c++)
+			for (q = 0; q < __arraycount(bench_quals); q++)
+			    bench_convert(dir, f, r, c, q);
+	for (f = 0; f < __arraycount(bench_fmts); f++)
+		bench_mix(f);
+
+	kmixer_samplerate_fini();
+	return 0;
+}
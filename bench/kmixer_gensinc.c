@@ -0,0 +1,105 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Generate the windowed-sinc prototype filters used by the polyphase
+ * resampler in kmixer_samplerate.c.  The kernel has no floating point,
+ * so the tables are computed here and compiled in:
+ *
+ *	./kmixer_gensinc > ../src/kmixer_samplerate_sinc.h
+ *
+ * Each table holds one side of a Kaiser-windowed sinc, sampled
+ * KMIXER_SINC_OVERSAMPLE times per zero crossing, in Q30.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#define KMIXER_SINC_OVERSAMPLE	128
+
+static const struct {
+	const char	*name;
+	const char	*macro;
+	int		zeros;		/* zero crossings per side */
+	double		beta;		/* Kaiser window shape */
+} filters[] = {
+	{ "short",	"SHORT",	8,	6.0 },
+	{ "long",	"LONG",		32,	9.0 },
+};
+
+/* zeroth order modified Bessel function of the first kind */
+static double
+bessel_i0(double x)
+{
+	double sum = 1, term = 1;
+	int k;
+
+	for (k = 1; k < 64; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+int
+main(void)
+{
+	double x, r, h;
+	unsigned int f;
+	int i, n;
+
+	printf("/* $NetBSD$ */\n\n");
+	printf("/*\n * Generated by bench/kmixer_gensinc.c, do not edit.\n");
+	printf(" * Kaiser-windowed sinc, %d points per zero crossing, Q30.\n",
+	    KMIXER_SINC_OVERSAMPLE);
+	printf(" */\n\n");
+	printf("#define KMIXER_SINC_OVERSAMPLE\t%d\n", KMIXER_SINC_OVERSAMPLE);
+	printf("#define KMIXER_SINC_ONE\t\t(1 << 30)\n");
+
+	for (f = 0; f < sizeof(filters) / sizeof(filters[0]); f++) {
+		n = filters[f].zeros * KMIXER_SINC_OVERSAMPLE;
+		printf("\n#define KMIXER_SINC_%s_ZEROS\t%d\n",
+		    filters[f].macro, filters[f].zeros);
+		printf("\nstatic const int32_t kmixer_sinc_%s[%d + 1] = {",
+		    filters[f].name, n);
+		for (i = 0; i <= n; i++) {
+			x = (double)i / KMIXER_SINC_OVERSAMPLE;
+			r = x / filters[f].zeros;
+			h = i == 0 ? 1 : sin(M_PI * x) / (M_PI * x);
+			h *= bessel_i0(filters[f].beta * sqrt(1 - r * r)) /
+			    bessel_i0(filters[f].beta);
+			if (i % 6 == 0)
+				printf("\n\t");
+			else
+				printf(" ");
+			printf("%ld,", lrint(h * (1 << 30)));
+		}
+		printf("\n};\n");
+	}
+	return 0;
+}
@@ -0,0 +1,151 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Generate the 8-bit sample decode tables and the dither table used by
+ * kmixer_mix.c:
+ *
+ *	./kmixer_gentables > ../src/kmixer_mix_tables.h
+ *
+ * Every 8-bit encoding decodes with one lookup to a 16-bit linear
+ * sample.  The companded formats follow ITU-T G.711.
+ *
+ * The dither table holds triangular (TPDF) noise, the difference of two
+ * uniform values, in 1/256ths of an output LSB: -255 to 255.  Entries
+ * come in pairs of opposite sign so the noise has no DC; the mixer
+ * reads them in random order.  Unlike the decode tables it is not
+ * static: the vector kernels in kmixer_simd_*.c index it too, through
+ * the declaration in kmixer_mix.h.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TPDF_BITS	10		/* KMIXER_TPDF_BITS */
+#define TPDF_SIZE	(1 << TPDF_BITS)
+
+static uint32_t
+xorshift32(uint32_t *x)
+{
+	*x ^= *x << 13;
+	*x ^= *x >> 17;
+	*x ^= *x << 5;
+	return *x;
+}
+
+static int
+ulaw_to_linear(unsigned int u)
+{
+	int t;
+
+	u = ~u & 0xff;
+	t = ((u & 0x0f) << 3) + 0x84;
+	t <<= (u & 0x70) >> 4;
+	return (u & 0x80) ? 0x84 - t : t - 0x84;
+}
+
+static int
+alaw_to_linear(unsigned int a)
+{
+	int t, seg;
+
+	a ^= 0x55;
+	t = (a & 0x0f) << 4;
+	seg = (a & 0x70) >> 4;
+	if (seg == 0)
+		t += 8;
+	else
+		t = (t + 0x108) << (seg - 1);
+	return (a & 0x80) ? t : -t;
+}
+
+static int
+slinear8_to_linear(unsigned int s)
+{
+	return (signed char)s * 256;
+}
+
+static int
+ulinear8_to_linear(unsigned int u)
+{
+	return ((int)u - 128) * 256;
+}
+
+static const struct {
+	const char	*name;
+	const char	*desc;
+	int		(*dec)(unsigned int);
+} tables[] = {
+	{ "ulaw",	"mu-law",		ulaw_to_linear },
+	{ "alaw",	"A-law",		alaw_to_linear },
+	{ "slinear8",	"signed 8-bit",		slinear8_to_linear },
+	{ "ulinear8",	"unsigned 8-bit",	ulinear8_to_linear },
+};
+
+int
+main(void)
+{
+	unsigned int t, i;
+	uint32_t x = 2463534242U;
+	int a = 0, b = 0;
+
+	printf("/* $NetBSD$ */\n\n");
+	printf("/*\n * Generated by bench/kmixer_gentables.c, do not edit.\n");
+	printf(" * 8-bit samples to 16-bit linear, and TPDF dither.\n");
+	printf(" */\n");
+
+	for (t = 0; t < sizeof(tables) / sizeof(tables[0]); t++) {
+		printf("\n/* %s */\n", tables[t].desc);
+		printf("static const int16_t kmixer_%s_table[256] = {",
+		    tables[t].name);
+		for (i = 0; i < 256; i++) {
+			if (i % 8 == 0)
+				printf("\n\t");
+			else
+				printf(" ");
+			printf("%d,", tables[t].dec(i));
+		}
+		printf("\n};\n");
+	}
+
+	printf("\n/* TPDF noise, 1/256 LSB */\n");
+	printf("const int16_t kmixer_tpdf_table[KMIXER_TPDF_SIZE] = {");
+	for (i = 0; i < TPDF_SIZE; i++) {
+		if (i % 2 == 0) {
+			a = xorshift32(&x) >> 24;
+			b = xorshift32(&x) >> 24;
+		}
+		if (i % 8 == 0)
+			printf("\n\t");
+		else
+			printf(" ");
+		printf("%d,", i % 2 == 0 ? a - b : b - a);
+	}
+	printf("\n};\n");
+	return 0;
+}
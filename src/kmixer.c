@@ -34,21 +34,42 @@ __KERNEL_RCSID(0, "$NetBSD$");
 #include <sys/conf.h>
 #include <sys/buf.h>
 #include <sys/kmem.h>
+#include <sys/pool.h>
 #include <sys/kernel.h>
+#include <sys/sysctl.h>
 #include <sys/device.h>
 #include <sys/module.h>
 #include <sys/proc.h>
 #include <sys/condvar.h>
 #include <sys/kthread.h>
 #include <sys/select.h>
+#include <sys/poll.h>
+#include <sys/event.h>
+#include <sys/filio.h>
 #include <sys/audioio.h>
 #include <sys/file.h>
 #include <sys/filedesc.h>
 #include <sys/vnode.h>
+#include <sys/uio.h>
+#include <sys/atomic.h>
+#include <sys/mman.h>
+#include <sys/evcnt.h>
+#include <sys/sdt.h>
+#include <sys/bitops.h>
+
+#ifdef __HAVE_CPU_COUNTER
+#include <machine/cpu_counter.h>
+#endif
+
+#include <uvm/uvm_extern.h>
 
 #include <dev/audiovar.h>
 #include <dev/auconv.h>
 
+#include "kmixer_samplerate.h"
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+#include "kmixerio.h"
 #include "kmixervar.h"
 
 #ifndef KMIXER_SAMPLE_RATE
@@ -56,6 +77,57 @@ __KERNEL_RCSID(0, "$NetBSD$");
 #endif
 
 #define KMIXER_BUFSIZE	AU_RING_SIZE
+#define KMIXER_BUFMAPSIZE	round_page(KMIXER_BUFSIZE)
+
+/* largest mixer period, in bytes of hardware format */
+#define KMIXER_MAXBLKSIZE	8192
+#define KMIXER_MAXBLKSAMPLES	(KMIXER_MAXBLKSIZE / 2)
+
+/* device blocks queued ahead while a short period is asked for */
+#define KMIXER_HWPERIODS	4
+
+/* per-group resampled bus, two periods of 32-bit samples */
+#define KMIXER_CVTSIZE	(KMIXER_MAXBLKSAMPLES * sizeof(int32_t) * 2)
+
+/* per-group bus samples summed at the client rate in one pass */
+#define KMIXER_SUMSAMPLES	KMIXER_MAXBLKSAMPLES
+
+#define KMIXER_QUALITY_DEFAULT	KMIXER_QUALITY_SHORT
+
+/* hw.kmixer.drift: which groups follow their device's clock */
+#define KMIXER_DRIFT_OFF	0
+#define KMIXER_DRIFT_RESAMPLED	1	/* groups converting rates anyway */
+#define KMIXER_DRIFT_ALL	2	/* all, resampling at equal rates */
+
+/* hw.kmixer.rate: the rate devices are run at */
+#define KMIXER_RATE_FIXED	0	/* KMIXER_SAMPLE_RATE */
+#define KMIXER_RATE_FIRST	1	/* the longest open channel's */
+#define KMIXER_RATE_MAJORITY	2	/* the one sparing most resampling */
+
+/* hw.kmixer.idle, milliseconds */
+#define KMIXER_IDLE_DEFAULT	5000
+#define KMIXER_IDLE_MAX		3600000
+
+/* channel gain changes are ramped over this long */
+#define KMIXER_RAMP_MS		5
+
+/* hw.kmixer.dither: reducing the mix bus to narrower devices */
+#define KMIXER_DITHER_OFF	0	/* truncate */
+#define KMIXER_DITHER_TPDF	1	/* add TPDF noise */
+#define KMIXER_DITHER_SHAPED	2	/* and shape it */
+
+/* delay-locked loop bandwidth, 0.1 Hz, as 2 * pi * B * 2^32 / 10^9 */
+#define KMIXER_CLOCK_OMEGA(ns)	((int64_t)(ns) * 269860 / 100000)
+
+/* ch_latstate */
+#define KMIXER_LAT_IDLE		0	/* writer may arm a new sample */
+#define KMIXER_LAT_ARMED	1	/* queued at ch_latpos */
+#define KMIXER_LAT_MIXED	2	/* mixed, awaiting the device write */
+
+CTASSERT(KMIXER_QUALITY_LINEAR == KMIXER_SAMPLERATE_LINEAR);
+CTASSERT(KMIXER_QUALITY_SHORT == KMIXER_SAMPLERATE_SHORT);
+CTASSERT(KMIXER_QUALITY_LONG == KMIXER_SAMPLERATE_LONG);
+CTASSERT(KMIXER_GAIN_UNITY == KMIXER_MIX_UNITY);
 
 static int	kmixer_attach(void);
 static int	kmixer_detach(void);
@@ -63,13 +135,37 @@ static int	kmixer_detach(void);
 static void	kmixer_enum_hw(struct kmixer_softc *);
 static void	kmixer_add_hw(struct kmixer_softc *, device_t);
 static void	kmixer_del_hw(struct kmixer_softc *, device_t);
+static void	kmixer_free_hw(struct kmixer_hw *);
+static void	kmixer_evcnt_attach_hw(struct kmixer_hw *);
+static void	kmixer_evcnt_detach_hw(struct kmixer_hw *);
+static void	kmixer_reap_hw(struct kmixer_softc *);
 static void	kmixer_select_hw(struct kmixer_softc *);
 static int	kmixer_open_hw(struct kmixer_softc *, struct kmixer_hw *);
 static void	kmixer_close_hw(struct kmixer_softc *, struct kmixer_hw *);
+static void	kmixer_period_hw(struct kmixer_softc *, struct kmixer_hw *);
+static void	kmixer_format_hw(struct kmixer_softc *, struct kmixer_hw *);
+static void	kmixer_hw_choose(struct kmixer_softc *, struct kmixer_hw *,
+				 audio_params_t *);
 static void	kmixer_devicehook(void *, device_t, int);
-
-static struct kmixer_ch * kmixer_alloc_chan(struct kmixer_softc *);
+static void	kmixer_migrate_thread(void *);
+static void	kmixer_sysctl_setup(struct kmixer_softc *);
+static void	kmixer_mixer_thread(void *);
+static void	kmixer_capture_thread(void *);
+
+static int	kmixer_chan_ctor(void *, void *, int);
+static void	kmixer_chan_dtor(void *, void *);
+static struct kmixer_ch * kmixer_alloc_chan(struct kmixer_softc *, int);
 static void	kmixer_free_chan(struct kmixer_ch *);
+static void	kmixer_chan_reset(struct kmixer_ch *);
+static void	kmixer_chan_join(struct kmixer_ch *);
+static void	kmixer_chan_leave(struct kmixer_ch *);
+static void	kmixer_chan_rec_reset(struct kmixer_ch *);
+static void	kmixer_chan_rec_join(struct kmixer_ch *);
+static void	kmixer_chan_rec_leave(struct kmixer_ch *);
+static void	kmixer_chan_route(struct kmixer_ch *);
+static void	kmixer_chan_rehome(struct kmixer_ch *, struct kmixer_hw *);
+static void	kmixer_chan_recheck(struct kmixer_ch *);
+static void	kmixer_route_del(struct kmixer_route *);
 
 dev_type_open(kmixer_open);
 
@@ -94,6 +190,9 @@ static int	kmixer_chan_write(struct file *, off_t *, struct uio *,
 static int	kmixer_chan_ioctl(struct file *, u_long, void *);
 static int	kmixer_chan_poll(struct file *, int);
 static int	kmixer_chan_close(struct file *);
+static int	kmixer_chan_kqfilter(struct file *, struct knote *);
+static int	kmixer_chan_mmap(struct file *, off_t *, size_t, int, int *,
+				 int *, struct uvm_object **, int *);
 
 static const struct fileops kmixer_fileops = {
 	.fo_read = kmixer_chan_read,
@@ -103,7 +202,8 @@ static const struct fileops kmixer_fileops = {
 	.fo_poll = kmixer_chan_poll,
 	.fo_stat = fbadop_stat,
 	.fo_close = kmixer_chan_close,
-	.fo_kqfilter = fnullop_kqfilter,
+	.fo_kqfilter = kmixer_chan_kqfilter,
+	.fo_mmap = kmixer_chan_mmap,
 };
 
 static const struct audio_params kmixer_hw_default = {
@@ -126,10 +226,32 @@ extern const struct cdevsw audio_cdevsw;
 
 static struct kmixer_softc *kmixer_softc = NULL;
 
+/*
+ * A sample's way to the device: queued by the writer, summed by each
+ * device's mixer, written to the device.  latency-done gives the time
+ * from enqueue to write of a sample timed for KMIXER_GETLATENCY.
+ */
+SDT_PROVIDER_DEFINE(kmixer);
+SDT_PROBE_DEFINE3(kmixer, chan, write, enqueue,
+    "struct kmixer_ch *", "u_int"/*tail*/, "size_t"/*bytes*/);
+SDT_PROBE_DEFINE3(kmixer, route, sum, mixed,
+    "struct kmixer_ch *", "struct kmixer_hw *", "size_t"/*frames*/);
+SDT_PROBE_DEFINE1(kmixer, hw, mix, start,
+    "struct kmixer_hw *");
+SDT_PROBE_DEFINE2(kmixer, hw, mix, done,
+    "struct kmixer_hw *", "uint64_t"/*nsec*/);
+SDT_PROBE_DEFINE2(kmixer, hw, write, start,
+    "struct kmixer_hw *", "size_t"/*bytes*/);
+SDT_PROBE_DEFINE2(kmixer, hw, write, done,
+    "struct kmixer_hw *", "int"/*error*/);
+SDT_PROBE_DEFINE3(kmixer, chan, latency, done,
+    "struct kmixer_ch *", "struct kmixer_hw *", "uint64_t"/*nsec*/);
+
 static int
 kmixer_attach(void)
 {
 	struct kmixer_softc *sc;
+	int err;
 
 	kmixer_softc = sc = kmem_zalloc(sizeof(*sc), KM_SLEEP);
 	if (sc == NULL) {
@@ -137,10 +259,36 @@ kmixer_attach(void)
 		return ENOMEM;
 	}
 
+	kmixer_samplerate_init();
+	kmixer_simd_init();
+	printf("kmixer: using %s kernels\n", kmixer_simd_name());
+
 	cv_init(&sc->sc_cv, "kmixer");
 	mutex_init(&sc->sc_lock, MUTEX_DEFAULT, IPL_NONE);
 	TAILQ_INIT(&sc->sc_hw);
-	TAILQ_INIT(&sc->sc_inact_ch);
+	TAILQ_INIT(&sc->sc_dead_hw);
+	TAILQ_INIT(&sc->sc_ch);
+	sc->sc_drift = KMIXER_DRIFT_RESAMPLED;
+	sc->sc_rate = KMIXER_RATE_MAJORITY;
+	sc->sc_idle = KMIXER_IDLE_DEFAULT;
+	sc->sc_dither = KMIXER_DITHER_TPDF;
+	sc->sc_chcache = pool_cache_init(sizeof(struct kmixer_ch),
+	    coherency_unit, 0, 0, "kmixerch", NULL, IPL_NONE,
+	    kmixer_chan_ctor, kmixer_chan_dtor, sc);
+	kmixer_sysctl_setup(sc);
+
+	err = kthread_create(PRI_NONE, KTHREAD_MPSAFE | KTHREAD_MUSTJOIN,
+	    NULL, kmixer_migrate_thread, sc, &sc->sc_mthread, "kmixer");
+	if (err) {
+		printf("kmixer: couldn't create migration thread (%d)\n", err);
+		sysctl_teardown(&sc->sc_sysctllog);
+		pool_cache_destroy(sc->sc_chcache);
+		mutex_destroy(&sc->sc_lock);
+		cv_destroy(&sc->sc_cv);
+		kmem_free(sc, sizeof(*sc));
+		kmixer_softc = NULL;
+		return err;
+	}
 
 	mutex_enter(&sc->sc_lock);
 	kmixer_enum_hw(sc);
@@ -158,21 +306,34 @@ kmixer_detach(void)
 
 	if (sc->sc_hook)
 		devicehook_disestablish(sc->sc_hook);
+	sysctl_teardown(&sc->sc_sysctllog);
+
+	mutex_enter(&sc->sc_lock);
+	sc->sc_dying = true;
+	cv_broadcast(&sc->sc_cv);
+	mutex_exit(&sc->sc_lock);
+	kthread_join(sc->sc_mthread);
 
 	cmaj = cdevsw_lookup_major(&kmixer_cdevsw);
 	mn = 0;
 	vdevgone(cmaj, mn, mn, VCHR);
 
-	mutex_destroy(&sc->sc_lock);
-	cv_destroy(&sc->sc_cv);
-
+	mutex_enter(&sc->sc_lock);
 	while (!TAILQ_EMPTY(&sc->sc_hw)) {
 		hw = TAILQ_FIRST(&sc->sc_hw);
 		kmixer_del_hw(sc, hw->hw_dev);
 	}
 	kmixer_select_hw(sc);
+	mutex_exit(&sc->sc_lock);
+
+	kmixer_reap_hw(sc);
+
+	pool_cache_destroy(sc->sc_chcache);
+	mutex_destroy(&sc->sc_lock);
+	cv_destroy(&sc->sc_cv);
 
 	kmem_free(sc, sizeof(*sc));
+	kmixer_samplerate_fini();
 	kmixer_softc = NULL;
 
 	return 0;
@@ -184,12 +345,16 @@ kmixer_open(dev_t dev, int flags, int fmt, struct lwp *l)
 	struct kmixer_softc *sc = kmixer_softc;
 	struct kmixer_ch *ch;
 	struct file *fp;
-	int err, fd;
+	int err, fd, mode = 0;
 
 	if (sc == NULL)
 		return ENXIO;
 
-	ch = kmixer_alloc_chan(sc);
+	if (flags & FWRITE)
+		mode |= AUMODE_PLAY;
+	if (flags & FREAD)
+		mode |= AUMODE_RECORD;
+	ch = kmixer_alloc_chan(sc, mode);
 	if (ch == NULL)
 		return ENOMEM;
 
@@ -229,12 +394,130 @@ kmixer_hw_busname(struct kmixer_hw *hw)
 	return bus ? device_xname(bus) : "<none>";
 }
 
+/* the device's bit in KMIXER_SETROUTE and hw.kmixer.nodither masks */
+static inline u_int
+kmixer_hw_bit(struct kmixer_hw *hw)
+{
+	int unit = device_unit(hw->hw_dev);
+
+	return unit < 32 ? __BIT(unit) : 0;
+}
+
+/* cycle count for the mix and conversion counters, 0 if there is none */
+static inline uint64_t
+kmixer_cycles(void)
+{
+#ifdef __HAVE_CPU_COUNTER
+	if (cpu_hascounter())
+		return cpu_counter();
+#endif
+	return 0;
+}
+
+static inline uint64_t
+kmixer_nsecs(void)
+{
+	struct timespec ts;
+
+	nanouptime(&ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* see struct kmixer_latency */
+static void
+kmixer_hist_add(uint64_t *hist, uint64_t nsec)
+{
+	uint64_t usec = nsec / 1000;
+
+	hist[usec ? MIN(fls64(usec) - 1, KMIXER_LATBUCKETS - 1) : 0]++;
+}
+
+static size_t
+kmixer_frame_size(const audio_params_t *p)
+{
+	return p->channels * (p->precision / NBBY);
+}
+
+/*
+ * The client rings are single-producer, single-consumer queues: only the
+ * producer advances the tail and only the consumer advances the head, so
+ * neither side takes a lock to move samples.  Indices run over
+ * [0, 2 * size) so that a full ring can be told from an empty one.
+ */
+static inline size_t
+kmixer_ring_used(size_t size, u_int head, u_int tail)
+{
+	return tail >= head ? tail - head : tail + 2 * size - head;
+}
+
+static inline size_t
+kmixer_ring_off(size_t size, u_int idx)
+{
+	return idx < size ? idx : idx - size;
+}
+
+static inline u_int
+kmixer_ring_adv(size_t size, u_int idx, size_t n)
+{
+	idx += n;
+	if (idx >= 2 * size)
+		idx -= 2 * size;
+	return idx;
+}
+
+/*
+ * Each device playing a channel consumes its ring at its own head, and
+ * the writer may only reuse what all of them have played: the head of
+ * the ring is the one with the most left to play.  Routes come and go
+ * under sc_lock, but are read here without it; a route is added at an
+ * existing head, and ch_rhead takes the head of the last one removed.
+ * A silent route plays nothing, so it is not waited for; its head is
+ * brought up to date when it joins a group, see kmixer_route_join().
+ */
+static u_int
+kmixer_chan_head(const struct kmixer_ch *ch, u_int tail)
+{
+	size_t used, n;
+	u_int mask, head, h;
+	int i;
+
+	mask = ch->ch_rtmask;
+	membar_consumer();
+	if (mask == 0)
+		return ch->ch_rhead;
+
+	head = tail;
+	used = 0;
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		if ((mask & __BIT(i)) == 0 || ch->ch_rt[i].rt_silent)
+			continue;
+		membar_consumer();
+		h = ch->ch_rt[i].rt_head;
+		n = kmixer_ring_used(ch->ch_bufsize, h, tail);
+		if (n >= used) {
+			used = n;
+			head = h;
+		}
+	}
+	return head;
+}
+
+static inline size_t
+kmixer_ring_free(const struct kmixer_ch *ch)
+{
+	u_int tail = ch->ch_rtail;
+
+	return ch->ch_bufsize - kmixer_ring_used(ch->ch_bufsize,
+	    kmixer_chan_head(ch, tail), tail);
+}
+
 static void
 kmixer_add_hw(struct kmixer_softc *sc, device_t hw_dev)
 {
 	struct kmixer_hw *hw;
 	device_t pdev, ppdev;
-	int mj, mn;
+	int mj, mn, err;
 
 	KASSERT(mutex_owned(&sc->sc_lock));
 
@@ -245,9 +528,23 @@ kmixer_add_hw(struct kmixer_softc *sc, device_t hw_dev)
 	}
 	mn = device_unit(hw_dev) + SOUND_DEVICE;
 
-	hw = kmem_alloc(sizeof(*hw), KM_SLEEP);
+	hw = kmem_zalloc(sizeof(*hw), KM_SLEEP);
 	hw->hw_dev = hw_dev;
 	hw->hw_audiodev = makedev(mj, mn);
+	hw->hw_softc = sc;
+	hw->hw_pparams = kmixer_hw_default;
+	hw->hw_mixbuf = kmem_alloc(KMIXER_MAXBLKSAMPLES * sizeof(int32_t),
+	    KM_SLEEP);
+	hw->hw_outbuf = kmem_alloc(KMIXER_MAXBLKSIZE, KM_SLEEP);
+	kmixer_mix_dither_init(&hw->hw_dither, device_unit(hw_dev));
+	hw->hw_rparams = kmixer_hw_default;
+	hw->hw_inbuf = kmem_alloc(KMIXER_MAXBLKSIZE, KM_SLEEP);
+	TAILQ_INIT(&hw->hw_routes);
+	TAILQ_INIT(&hw->hw_pgroups);
+	TAILQ_INIT(&hw->hw_rgroups);
+	mutex_init(&hw->hw_lock, MUTEX_DEFAULT, IPL_NONE);
+	cv_init(&hw->hw_cv, "kmixerhw");
+	kmixer_evcnt_attach_hw(hw);
 
 	pdev = device_parent(hw_dev);
 	ppdev = device_parent(pdev);
@@ -256,25 +553,145 @@ kmixer_add_hw(struct kmixer_softc *sc, device_t hw_dev)
 	    kmixer_hw_devname(hw), kmixer_hw_parentname(hw),
 	    kmixer_hw_busname(hw));
 
+	err = kthread_create(PRI_NONE, KTHREAD_MPSAFE | KTHREAD_MUSTJOIN,
+	    NULL, kmixer_mixer_thread, hw, &hw->hw_thread, "kmixer/%s",
+	    kmixer_hw_devname(hw));
+	if (err) {
+		printf("kmixer: couldn't create mixer thread (%d)\n", err);
+		kmixer_free_hw(hw);
+		return;
+	}
+
+	err = kthread_create(PRI_NONE, KTHREAD_MPSAFE | KTHREAD_MUSTJOIN,
+	    NULL, kmixer_capture_thread, hw, &hw->hw_rthread, "kmixrec/%s",
+	    kmixer_hw_devname(hw));
+	if (err) {
+		printf("kmixer: couldn't create capture thread (%d)\n", err);
+		/* the mixer thread is joined by kmixer_reap_hw */
+		mutex_enter(&hw->hw_lock);
+		hw->hw_dying = true;
+		cv_broadcast(&hw->hw_cv);
+		mutex_exit(&hw->hw_lock);
+		TAILQ_INSERT_TAIL(&sc->sc_dead_hw, hw, hw_entry);
+		return;
+	}
+
 	TAILQ_INSERT_TAIL(&sc->sc_hw, hw, hw_entry);
+	sc->sc_hwgen++;
 }
 
 static void
 kmixer_del_hw(struct kmixer_softc *sc, device_t hw_dev)
 {
 	struct kmixer_hw *hw;
+	struct kmixer_route *rt;
+	struct kmixer_ch *ch;
 
 	KASSERT(mutex_owned(&sc->sc_lock));
 
 	TAILQ_FOREACH(hw, &sc->sc_hw, hw_entry) {
 		if (hw->hw_dev == hw_dev) {
 			TAILQ_REMOVE(&sc->sc_hw, hw, hw_entry);
-			kmem_free(hw, sizeof(*hw));
+			sc->sc_hwgen++;
+			if (sc->sc_selhw == hw)
+				sc->sc_selhw = NULL;
+			/* an opener routes its channels before this wakes */
+			while (hw->hw_opening)
+				cv_wait(&sc->sc_cv, &sc->sc_lock);
+			/* channels go on with their other devices, if any */
+			while ((rt = TAILQ_FIRST(&hw->hw_routes)) != NULL) {
+				ch = rt->rt_ch;
+				kmixer_route_del(rt);
+				kmixer_chan_rehome(ch, hw);
+			}
+			kmixer_close_hw(sc, hw);
+			/* the threads are joined by kmixer_reap_hw */
+			mutex_enter(&hw->hw_lock);
+			hw->hw_dying = true;
+			cv_broadcast(&hw->hw_cv);
+			mutex_exit(&hw->hw_lock);
+			TAILQ_INSERT_TAIL(&sc->sc_dead_hw, hw, hw_entry);
 			break;
 		}
 	}
 }
 
+/* vmstat -e shows these under "kmixer/<device>" */
+static void
+kmixer_evcnt_attach_hw(struct kmixer_hw *hw)
+{
+	const char *g = hw->hw_evgroup;
+
+	snprintf(hw->hw_evgroup, sizeof(hw->hw_evgroup), "kmixer/%s",
+	    kmixer_hw_devname(hw));
+	evcnt_attach_dynamic(&hw->hw_ev_frames, EVCNT_TYPE_MISC, NULL, g,
+	    "play frames");
+	evcnt_attach_dynamic(&hw->hw_ev_underruns, EVCNT_TYPE_MISC, NULL, g,
+	    "play underruns");
+	evcnt_attach_dynamic(&hw->hw_ev_late, EVCNT_TYPE_MISC, NULL, g,
+	    "late periods");
+	evcnt_attach_dynamic(&hw->hw_ev_mixcycles, EVCNT_TYPE_MISC, NULL, g,
+	    "mix cycles");
+	evcnt_attach_dynamic(&hw->hw_ev_cvtcycles, EVCNT_TYPE_MISC, NULL, g,
+	    "convert cycles");
+	evcnt_attach_dynamic(&hw->hw_ev_recframes, EVCNT_TYPE_MISC, NULL, g,
+	    "record frames");
+	evcnt_attach_dynamic(&hw->hw_ev_overruns, EVCNT_TYPE_MISC, NULL, g,
+	    "record overruns");
+	evcnt_attach_dynamic(&hw->hw_ev_suspends, EVCNT_TYPE_MISC, NULL, g,
+	    "idle suspends");
+}
+
+static void
+kmixer_evcnt_detach_hw(struct kmixer_hw *hw)
+{
+	evcnt_detach(&hw->hw_ev_frames);
+	evcnt_detach(&hw->hw_ev_underruns);
+	evcnt_detach(&hw->hw_ev_late);
+	evcnt_detach(&hw->hw_ev_mixcycles);
+	evcnt_detach(&hw->hw_ev_cvtcycles);
+	evcnt_detach(&hw->hw_ev_recframes);
+	evcnt_detach(&hw->hw_ev_overruns);
+	evcnt_detach(&hw->hw_ev_suspends);
+}
+
+static void
+kmixer_free_hw(struct kmixer_hw *hw)
+{
+	KASSERT(TAILQ_EMPTY(&hw->hw_pgroups));
+	KASSERT(TAILQ_EMPTY(&hw->hw_rgroups));
+
+	kmixer_evcnt_detach_hw(hw);
+	cv_destroy(&hw->hw_cv);
+	mutex_destroy(&hw->hw_lock);
+	kmem_free(hw->hw_mixbuf, KMIXER_MAXBLKSAMPLES * sizeof(int32_t));
+	kmem_free(hw->hw_outbuf, KMIXER_MAXBLKSIZE);
+	kmem_free(hw->hw_inbuf, KMIXER_MAXBLKSIZE);
+	kmem_free(hw, sizeof(*hw));
+}
+
+/*
+ * Wait for the threads of removed devices to exit and release them.
+ * Must be called without sc_lock held.
+ */
+static void
+kmixer_reap_hw(struct kmixer_softc *sc)
+{
+	struct kmixer_hw *hw;
+
+	mutex_enter(&sc->sc_lock);
+	while ((hw = TAILQ_FIRST(&sc->sc_dead_hw)) != NULL) {
+		TAILQ_REMOVE(&sc->sc_dead_hw, hw, hw_entry);
+		mutex_exit(&sc->sc_lock);
+		kthread_join(hw->hw_thread);
+		if (hw->hw_rthread != NULL)
+			kthread_join(hw->hw_rthread);
+		kmixer_free_hw(hw);
+		mutex_enter(&sc->sc_lock);
+	}
+	mutex_exit(&sc->sc_lock);
+}
+
 static void
 kmixer_enum_hw(struct kmixer_softc *sc)
 {
@@ -334,10 +751,154 @@ kmixer_select_hw(struct kmixer_softc *sc)
 	}
 }
 
+/*
+ * Have the migration thread bring every channel's routes in line with
+ * the devices present, see kmixer_migrate_thread().
+ */
+static void
+kmixer_migrate_kick(struct kmixer_softc *sc)
+{
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	sc->sc_migrate = true;
+	cv_broadcast(&sc->sc_cv);
+}
+
+/*
+ * Read back the block size the driver settled on for a format; the
+ * mixer writes one block per period.
+ */
+static int
+kmixer_blksize_hw(struct kmixer_hw *hw, const audio_params_t *p,
+    struct audio_info *ai, size_t *blksizep)
+{
+	size_t blksize;
+	int err;
+
+	err = cdev_ioctl(hw->hw_audiodev, AUDIO_GETINFO, ai,
+	    FREAD|FWRITE, &lwp0);
+	if (err)
+		return err;
+	blksize = MIN(MAX(ai->blocksize, 1), KMIXER_MAXBLKSIZE);
+	blksize -= blksize % kmixer_frame_size(p);
+	if (blksize == 0)
+		return EINVAL;
+	*blksizep = blksize;
+
+	return 0;
+}
+
+/*
+ * The encodings the mixer runs a device at: linear ones of either byte
+ * order, which the mix bus writes and the converter resamples and maps
+ * in for capture, no narrower than the bus period buffers allow, see
+ * KMIXER_MAXBLKSAMPLES.
+ */
+static u_int
+kmixer_enc_bit(int encoding, int precision)
+{
+	int i;
+
+	switch (precision) {
+	case 16:
+		i = 0;
+		break;
+	case 24:
+		i = 1;
+		break;
+	case 32:
+		i = 2;
+		break;
+	default:
+		return 0;
+	}
+	switch (encoding) {
+	case AUDIO_ENCODING_SLINEAR_LE:
+		return __BIT(i);
+	case AUDIO_ENCODING_SLINEAR_BE:
+		return __BIT(i + 3);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Note the encodings the driver takes without audio(4) converting them.
+ * There is no such list of rates: a rate is native if the driver keeps
+ * it, see kmixer_setformat_hw().
+ */
+static void
+kmixer_getenc_hw(struct kmixer_hw *hw)
+{
+	struct audio_encoding ae;
+	u_int encs = 0;
+
+	for (ae.index = 0;; ae.index++) {
+		if (cdev_ioctl(hw->hw_audiodev, AUDIO_GETENC, &ae,
+		    FREAD|FWRITE, &lwp0) != 0)
+			break;
+		if ((ae.flags & AUDIO_ENCODINGFLAG_EMULATED) == 0)
+			encs |= kmixer_enc_bit(ae.encoding, ae.precision);
+	}
+	hw->hw_encs = encs;
+}
+
+/*
+ * Play and record in a format and read back the block size.  Drivers
+ * round a rate or channel count they lack to one they have, which
+ * counts as refusing the format.
+ */
+static int
+kmixer_setformat_hw(struct kmixer_hw *hw, const audio_params_t *p,
+    struct audio_info *ai, size_t *blksizep)
+{
+	int err;
+
+	AUDIO_INITINFO(ai);
+	ai->play.sample_rate = p->sample_rate;
+	ai->play.channels = p->channels;
+	ai->play.precision = p->precision;
+	ai->play.encoding = p->encoding;
+	ai->record.sample_rate = p->sample_rate;
+	ai->record.channels = p->channels;
+	ai->record.precision = p->precision;
+	ai->record.encoding = p->encoding;
+	ai->mode = AUMODE_PLAY | AUMODE_RECORD;
+	/* a device left paused by kmixer_hw_suspend() plays again */
+	ai->play.pause = 0;
+	err = cdev_ioctl(hw->hw_audiodev, AUDIO_SETINFO, ai,
+	    FREAD|FWRITE, &lwp0);
+	if (err)
+		return err;
+
+	err = kmixer_blksize_hw(hw, p, ai, blksizep);
+	if (err)
+		return err;
+	if (ai->play.sample_rate != p->sample_rate ||
+	    ai->play.channels != p->channels ||
+	    ai->play.precision != p->precision ||
+	    ai->play.encoding != p->encoding ||
+	    ai->record.sample_rate != p->sample_rate ||
+	    ai->record.channels != p->channels ||
+	    ai->record.precision != p->precision ||
+	    ai->record.encoding != p->encoding)
+		return EINVAL;
+
+	return 0;
+}
+
+/*
+ * Open a device and set its format, see kmixer_hw_choose().  Drivers
+ * may sleep for a long time in open, so sc_lock is dropped meanwhile
+ * and hw_opening keeps other openers and kmixer_del_hw() waiting on
+ * sc_cv.
+ */
 static int
 kmixer_open_hw(struct kmixer_softc *sc, struct kmixer_hw *hw)
 {
 	struct audio_info ai;
+	audio_params_t p, bad;
+	size_t blksize;
 	int err;
 
 	KASSERT(mutex_owned(&sc->sc_lock));
@@ -345,33 +906,60 @@ kmixer_open_hw(struct kmixer_softc *sc, struct kmixer_hw *hw)
 	if (hw == NULL)
 		return ENODEV;
 
-	if (!TAILQ_EMPTY(&hw->hw_act_ch))
+	while (hw->hw_opening)
+		cv_wait(&sc->sc_cv, &sc->sc_lock);
+	if (hw->hw_open)
 		return 0;
+	if (hw->hw_dying)
+		return ENODEV;
+
+	hw->hw_opening = true;
+	mutex_exit(&sc->sc_lock);
 
+	memset(&bad, 0, sizeof(bad));
 	err = cdev_open(hw->hw_audiodev, FREAD|FWRITE, 0, &lwp0);
-	if (err) {
-		return err;
-	}
+	if (err)
+		goto out;
 
-	AUDIO_INITINFO(&ai);
-	ai.play.sample_rate = kmixer_hw_default.sample_rate;
-	ai.play.channels = kmixer_hw_default.channels;
-	ai.play.precision = kmixer_hw_default.precision;
-	ai.play.encoding = kmixer_hw_default.encoding;
-	ai.record.sample_rate = kmixer_hw_default.sample_rate;
-	ai.record.channels = kmixer_hw_default.channels;
-	ai.record.precision = kmixer_hw_default.precision;
-	ai.record.encoding = kmixer_hw_default.encoding;
-	ai.mode = AUMODE_PLAY | AUMODE_RECORD;
-	err = cdev_ioctl(hw->hw_audiodev, AUDIO_SETINFO, &ai,
-	    FREAD|FWRITE, &lwp0);
+	/* hw_encs is only read under sc_lock once hw_opening is clear */
+	kmixer_getenc_hw(hw);
+	mutex_enter(&sc->sc_lock);
+	kmixer_hw_choose(sc, hw, &p);
+	mutex_exit(&sc->sc_lock);
+
+	err = kmixer_setformat_hw(hw, &p, &ai, &blksize);
+	if (err && memcmp(&p, &kmixer_hw_default, sizeof(p)) != 0) {
+		bad = p;
+		p = kmixer_hw_default;
+		err = kmixer_setformat_hw(hw, &p, &ai, &blksize);
+	}
 	if (err)
 		goto fail;
-
-	return 0;
+	goto out;
 
 fail:
 	cdev_close(hw->hw_audiodev, FREAD|FWRITE, 0, &lwp0);
+out:
+	mutex_enter(&sc->sc_lock);
+	hw->hw_opening = false;
+	cv_broadcast(&sc->sc_cv);
+	if (bad.sample_rate != 0)
+		hw->hw_badfmt = bad;
+	if (err == 0) {
+		mutex_enter(&hw->hw_lock);
+		hw->hw_pparams = hw->hw_rparams = p;
+		hw->hw_blksize = blksize;
+		/* kmixer_period_hw() restores these when nobody wants one */
+		hw->hw_period = 0;
+		hw->hw_defblksize = ai.blocksize;
+		hw->hw_defhiwat = ai.hiwat;
+		memset(&hw->hw_pclock, 0, sizeof(hw->hw_pclock));
+		memset(&hw->hw_rclock, 0, sizeof(hw->hw_rclock));
+		hw->hw_open = true;
+		cv_broadcast(&hw->hw_cv);
+		mutex_exit(&hw->hw_lock);
+	}
+
 	return err;
 }
 
@@ -380,114 +968,2814 @@ kmixer_close_hw(struct kmixer_softc *sc, struct kmixer_hw *hw)
 {
 	KASSERT(mutex_owned(&sc->sc_lock));
 
-	if (TAILQ_EMPTY(&hw->hw_act_ch)) {
+	if (TAILQ_EMPTY(&hw->hw_routes) && hw->hw_open) {
+		mutex_enter(&hw->hw_lock);
+		hw->hw_open = false;
+		while (hw->hw_busy || hw->hw_rbusy)
+			cv_wait(&hw->hw_cv, &hw->hw_lock);
+		mutex_exit(&hw->hw_lock);
 		cdev_close(hw->hw_audiodev, FREAD|FWRITE, 0, &lwp0);
 	}
 }
 
+/*
+ * Mix at the shortest period asked for by hw.kmixer.period and by the
+ * channels playing on the device, see KMIXER_SETPERIOD, or at the
+ * driver's block size if nobody asks.  A short period also keeps only
+ * a few blocks queued in the driver.
+ */
 static void
-kmixer_devicehook(void *arg, device_t dev, int event)
+kmixer_period_hw(struct kmixer_softc *sc, struct kmixer_hw *hw)
 {
-	struct kmixer_softc *sc = arg;
+	const size_t fsize = kmixer_frame_size(&hw->hw_pparams);
+	struct kmixer_route *rt;
+	struct audio_info ai;
+	size_t blksize;
+	u_int period, req;
+	int err;
 
-	if (!device_is_a(dev, "audio"))
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	if (!hw->hw_open)
 		return;
 
-	mutex_enter(&sc->sc_lock);
+	period = sc->sc_period;
+	TAILQ_FOREACH(rt, &hw->hw_routes, rt_entry) {
+		req = rt->rt_ch->ch_periodreq;
+		if (req != 0 && (period == 0 || req < period))
+			period = req;
+	}
+	if (period == hw->hw_period)
+		return;
+	hw->hw_period = period;
 
-	switch (event) {
-	case DEVICE_ATTACHED:
-		kmixer_add_hw(sc, dev);
-		break;
-	case DEVICE_DETACHED:
-		kmixer_del_hw(sc, dev);
-		break;
+	AUDIO_INITINFO(&ai);
+	if (period == 0) {
+		ai.blocksize = hw->hw_defblksize;
+		ai.hiwat = hw->hw_defhiwat;
+	} else {
+		blksize = (uint64_t)hw->hw_pparams.sample_rate * period /
+		    1000000 * fsize;
+		ai.blocksize = MIN(MAX(blksize, fsize), KMIXER_MAXBLKSIZE);
+		ai.hiwat = KMIXER_HWPERIODS;
 	}
+	/* a device left paused by kmixer_hw_suspend() plays again */
+	ai.play.pause = 0;
+
+	/*
+	 * audio(4) reallocates its buffers, so the threads are kept out.
+	 * Waiting for them may take a driver block: as in
+	 * kmixer_format_hw(), sc_lock is dropped meanwhile and hw_opening
+	 * keeps openers and kmixer_del_hw() away.
+	 */
+	hw->hw_opening = true;
+	mutex_exit(&sc->sc_lock);
 
-	kmixer_select_hw(sc);
+	mutex_enter(&hw->hw_lock);
+	hw->hw_open = false;
+	while (hw->hw_busy || hw->hw_rbusy)
+		cv_wait(&hw->hw_cv, &hw->hw_lock);
+	mutex_exit(&hw->hw_lock);
 
-	mutex_exit(&sc->sc_lock);
+	err = cdev_ioctl(hw->hw_audiodev, AUDIO_SETINFO, &ai,
+	    FREAD|FWRITE, &lwp0);
+	if (err == 0)
+		err = kmixer_blksize_hw(hw, &hw->hw_pparams, &ai, &blksize);
+	if (err)
+		printf("kmixer: %s: couldn't set period (%d)\n",
+		    kmixer_hw_devname(hw), err);
+
+	mutex_enter(&hw->hw_lock);
+	if (err == 0)
+		hw->hw_blksize = blksize;
+	hw->hw_open = true;
+	cv_broadcast(&hw->hw_cv);
+	mutex_exit(&hw->hw_lock);
 
+	mutex_enter(&sc->sc_lock);
+	hw->hw_opening = false;
+	cv_broadcast(&sc->sc_cv);
 }
 
-static struct kmixer_ch *
-kmixer_alloc_chan(struct kmixer_softc *sc)
+/* the period a device mixes at, in microseconds */
+static u_int
+kmixer_hw_period(struct kmixer_hw *hw)
 {
-	struct kmixer_ch *ch;
-	int err;
-
-	ch = kmem_zalloc(sizeof(*ch), KM_SLEEP);
-	if (ch == NULL)
-		return NULL;
+	return (uint64_t)hw->hw_blksize / kmixer_frame_size(&hw->hw_pparams) *
+	    1000000 / hw->hw_pparams.sample_rate;
+}
 
-	ch->ch_softc = sc;
-	cv_init(&ch->ch_cv, "kmixerch");
-	mutex_init(&ch->ch_lock, MUTEX_DEFAULT, IPL_AUDIO);
-	ch->ch_pparams = kmixer_ch_default;
+static int
+kmixer_write_hw(struct kmixer_hw *hw)
+{
+	struct iovec iov;
+	struct uio uio;
+
+	iov.iov_base = hw->hw_outbuf;
+	iov.iov_len = hw->hw_blksize;
+	uio.uio_iov = &iov;
+	uio.uio_iovcnt = 1;
+	uio.uio_offset = 0;
+	uio.uio_resid = hw->hw_blksize;
+	uio.uio_rw = UIO_WRITE;
+	UIO_SETUP_SYSSPACE(&uio);
+
+	return cdev_write(hw->hw_audiodev, &uio, 0);
+}
 
-	mutex_enter(&sc->sc_lock);
-	if (sc->sc_selhw) {
-		err = kmixer_open_hw(sc, sc->sc_selhw);
-		if (err == 0) {
-			ch->ch_selhw = sc->sc_selhw;
-			TAILQ_INSERT_TAIL(&ch->ch_selhw->hw_act_ch,
-			    ch, ch_entry);
-		}
-	}
-	if (ch->ch_selhw == NULL) {
-		TAILQ_INSERT_TAIL(&sc->sc_inact_ch, ch, ch_entry);
-	}
-	mutex_exit(&sc->sc_lock);
+/*
+ * The converter and the mixer treat a group's sum as 32-bit samples
+ * in native byte order, at the bus scale.
+ */
+static void
+kmixer_bus_params(const audio_params_t *p, audio_params_t *bp)
+{
+	*bp = *p;
+	bp->encoding = AUDIO_ENCODING_SLINEAR_NE;
+	bp->precision = bp->validbits = 32;
+}
 
-	if (err) {
-		kmem_free(ch, sizeof(*ch));
-		ch = NULL;
+static void
+kmixer_pgroup_free(struct kmixer_pgroup *pg)
+{
+	if (!pg->pg_direct) {
+		kmixer_samplerate_destroy_context(&pg->pg_ctx);
+		kmem_free(pg->pg_sum, KMIXER_SUMSAMPLES * sizeof(int32_t));
+		kmem_free(pg->pg_cvtbuf, KMIXER_CVTSIZE);
 	}
-
-	return ch;
+	kmem_free(pg, sizeof(*pg));
 }
 
-static void
-kmixer_free_chan(struct kmixer_ch *ch)
+static struct kmixer_pgroup *
+kmixer_pgroup_find(struct kmixer_hw *hw, const audio_params_t *p,
+    int quality)
 {
-	struct kmixer_softc *sc = ch->ch_softc;
+	struct kmixer_pgroup *pg;
 
-	mutex_enter(&sc->sc_lock);
-	if (ch->ch_selhw) {
-		TAILQ_REMOVE(&ch->ch_selhw->hw_act_ch, ch, ch_entry);
-		kmixer_close_hw(sc, ch->ch_selhw);
-	} else {
-		TAILQ_REMOVE(&sc->sc_inact_ch, ch, ch_entry);
+	KASSERT(mutex_owned(&hw->hw_softc->sc_lock) ||
+	    mutex_owned(&hw->hw_lock));
+
+	TAILQ_FOREACH(pg, &hw->hw_pgroups, pg_entry) {
+		if (pg->pg_quality == quality &&
+		    memcmp(&pg->pg_params, p, sizeof(*p)) == 0)
+			return pg;
 	}
-	mutex_exit(&sc->sc_lock);
 
-	mutex_destroy(&ch->ch_lock);
-	cv_destroy(&ch->ch_cv);
-	kmem_free(ch, sizeof(*ch));
+	return NULL;
 }
 
-static int
-kmixer_chan_read(struct file *fp, off_t *offp, struct uio *uio,
-    kauth_cred_t cred, int flags)
+/*
+ * Whether a new group converting between the rates should follow its
+ * device's clock, see kmixer_clock_update().
+ */
+static bool
+kmixer_steer(struct kmixer_softc *sc, u_int rate, u_int hwrate)
 {
-	return EIO;	/* TODO */
-}
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	switch (sc->sc_drift) {
+	case KMIXER_DRIFT_RESAMPLED:
+		return rate != hwrate;
+	case KMIXER_DRIFT_ALL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Find or create the group playing a format on a device.  Returns NULL
+ * if the converter cannot take it to the hardware.
+ */
+static struct kmixer_pgroup *
+kmixer_pgroup_get(struct kmixer_hw *hw, const audio_params_t *p,
+    int quality)
+{
+	struct kmixer_pgroup *pg;
+
+	KASSERT(mutex_owned(&hw->hw_softc->sc_lock));
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	pg = kmixer_pgroup_find(hw, p, quality);
+	if (pg != NULL)
+		return pg;
+
+	pg = kmem_zalloc(sizeof(*pg), KM_SLEEP);
+	pg->pg_hw = hw;
+	TAILQ_INIT(&pg->pg_rt);
+	pg->pg_params = *p;
+	pg->pg_quality = quality;
+	kmixer_bus_params(p, &pg->pg_sparams);
+	kmixer_bus_params(&hw->hw_pparams, &pg->pg_cparams);
+	pg->pg_steer = kmixer_steer(hw->hw_softc, p->sample_rate,
+	    hw->hw_pparams.sample_rate);
+	pg->pg_direct = p->sample_rate == hw->hw_pparams.sample_rate &&
+	    p->channels == hw->hw_pparams.channels && !pg->pg_steer;
+	pg->pg_native = pg->pg_direct &&
+	    p->encoding == hw->hw_pparams.encoding &&
+	    p->precision == hw->hw_pparams.precision;
+
+	if (!pg->pg_direct) {
+		pg->pg_sum = kmem_alloc(KMIXER_SUMSAMPLES * sizeof(int32_t),
+		    KM_SLEEP);
+		pg->pg_cvtbuf = kmem_alloc(KMIXER_CVTSIZE, KM_SLEEP);
+		if (kmixer_samplerate_init_context(&pg->pg_ctx,
+		    &pg->pg_sparams, &pg->pg_cparams, quality, pg->pg_steer,
+		    pg->pg_cvtbuf, pg->pg_cvtbuf + KMIXER_CVTSIZE) != 0) {
+			kmem_free(pg->pg_sum,
+			    KMIXER_SUMSAMPLES * sizeof(int32_t));
+			kmem_free(pg->pg_cvtbuf, KMIXER_CVTSIZE);
+			kmem_free(pg, sizeof(*pg));
+			return NULL;
+		}
+	}
+
+	TAILQ_INSERT_TAIL(&hw->hw_pgroups, pg, pg_entry);
+
+	return pg;
+}
+
+/*
+ * Latency is sampled one queued sample at a time per channel.  The
+ * writer arms ch_latpos when idle, the first route to mix past it marks
+ * itself, and its mixer thread records the time once the block has been
+ * written, see kmixer_lat_done().
+ */
+static inline uint64_t
+kmixer_lat_stamp(const struct kmixer_ch *ch)
+{
+	return ch->ch_latstate == KMIXER_LAT_IDLE ? kmixer_nsecs() : 0;
+}
+
+static void
+kmixer_lat_arm(struct kmixer_ch *ch, u_int tail, uint64_t stamp)
+{
+	KASSERT(mutex_owned(&ch->ch_wlock));
+
+	if (stamp == 0)
+		return;
+	ch->ch_latpos = tail;
+	ch->ch_latenq = stamp;
+	membar_producer();
+	ch->ch_latstate = KMIXER_LAT_ARMED;
+}
+
+/* called before rt_head advances by len bytes */
+static void
+kmixer_lat_mixed(struct kmixer_route *rt, size_t len)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+
+	/* ch_latpos is set before ch_latstate */
+	membar_consumer();
+	if (kmixer_ring_used(ch->ch_bufsize, rt->rt_head, ch->ch_latpos) > len)
+		return;
+	if (atomic_cas_uint(&ch->ch_latstate, KMIXER_LAT_ARMED,
+	    KMIXER_LAT_MIXED) != KMIXER_LAT_ARMED)
+		return;
+	rt->rt_latmark = true;
+	rt->rt_hw->hw_latmarks++;
+}
+
+static void
+kmixer_lat_clear(struct kmixer_route *rt)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+
+	KASSERT(mutex_owned(&rt->rt_hw->hw_lock));
+
+	if (!rt->rt_latmark)
+		return;
+	rt->rt_latmark = false;
+	rt->rt_hw->hw_latmarks--;
+	/* done with ch_latenq before the writer may set it again */
+	membar_exit();
+	ch->ch_latstate = KMIXER_LAT_IDLE;
+}
+
+static void
+kmixer_lat_done(struct kmixer_hw *hw, int err)
+{
+	struct kmixer_route *rt;
+	struct kmixer_ch *ch;
+	uint64_t now, lat;
+
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	now = kmixer_nsecs();
+	TAILQ_FOREACH(rt, &hw->hw_routes, rt_entry) {
+		if (!rt->rt_latmark)
+			continue;
+		ch = rt->rt_ch;
+		if (err == 0) {
+			lat = now - ch->ch_latenq;
+			kmixer_hist_add(ch->ch_lathist, lat);
+			SDT_PROBE3(kmixer, chan, latency, done, ch, hw, lat);
+		}
+		kmixer_lat_clear(rt);
+	}
+}
+
+/*
+ * Account for len bytes a route took from its channel's ring and hand
+ * the space back, once they have been read up to the new head.
+ */
+static size_t
+kmixer_route_took(struct kmixer_route *rt, u_int head, size_t len,
+    uint64_t cycles)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+
+	/* done reading before the writer may reuse the space */
+	membar_exit();
+	if (ch->ch_latstate == KMIXER_LAT_ARMED)
+		kmixer_lat_mixed(rt, len);
+	rt->rt_head = head;
+
+	rt->rt_got = len / kmixer_frame_size(&ch->ch_pparams);
+	if (rt->rt_got > 0)
+		rt->rt_hw->hw_played = true;
+	rt->rt_frames += rt->rt_got;
+	rt->rt_cycles += kmixer_cycles() - cycles;
+	SDT_PROBE3(kmixer, route, sum, mixed, ch, rt->rt_hw, rt->rt_got);
+
+	return rt->rt_got;
+}
+
+/*
+ * Aim a route's ramp at its channel's gain, over KMIXER_RAMP_MS if ramp
+ * is set or at once.  Stereo channels take the panned pair.
+ */
+static void
+kmixer_route_gain(struct kmixer_route *rt, bool ramp)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+	const audio_params_t *p = &ch->ch_pparams;
+	int32_t target[2];
+	u_int gen;
+
+	/* a consistent set, read again if KMIXER_SETGAIN ran meanwhile */
+	do {
+		gen = ch->ch_gaingen;
+		membar_consumer();
+		if (p->channels == 2) {
+			target[0] = ch->ch_gain[0];
+			target[1] = ch->ch_gain[1];
+		} else
+			target[0] = target[1] = ch->ch_gain[2];
+		membar_consumer();
+	} while ((gen & 1) != 0 || ch->ch_gaingen != gen);
+
+	if (!ramp || target[0] != rt->rt_ramp.r_target[0] ||
+	    target[1] != rt->rt_ramp.r_target[1])
+		kmixer_mix_ramp(&rt->rt_ramp, target,
+		    ramp ? p->sample_rate * KMIXER_RAMP_MS / 1000 : 0);
+}
+
+/*
+ * Add up to nframes of the frames a route has still to play to a bus at
+ * the channel's own rate and channels, scaled by the channel's gain.
+ * Returns the number of frames taken.
+ */
+static size_t
+kmixer_route_sum(struct kmixer_route *rt, int32_t *bus, size_t nframes)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+	const audio_params_t *p = &ch->ch_pparams;
+	const size_t fsize = kmixer_frame_size(p);
+	const size_t ssize = p->precision / NBBY;
+	size_t off, len, done, n;
+	uint64_t cycles;
+	u_int head, tail;
+
+	/* idle channels cost one comparison */
+	head = rt->rt_head;
+	tail = ch->ch_rtail;
+	if (head == tail) {
+		rt->rt_got = 0;
+		return 0;
+	}
+
+	cycles = kmixer_cycles();
+	membar_consumer();
+	len = kmixer_ring_used(ch->ch_bufsize, head, tail);
+	len = MIN(len - len % fsize, nframes * fsize);
+	kmixer_route_gain(rt, true);
+
+	/* the ring holds whole frames, so runs split between frames */
+	for (done = 0; done < len; done += n) {
+		off = kmixer_ring_off(ch->ch_bufsize, head);
+		n = MIN(len - done, ch->ch_bufsize - off);
+		kmixer_mix_add_gain(bus + done / ssize, ch->ch_buf + off, p,
+		    n / fsize, &rt->rt_ramp);
+		head = kmixer_ring_adv(ch->ch_bufsize, head, n);
+	}
+
+	return kmixer_route_took(rt, head, len, cycles);
+}
+
+/*
+ * Copy up to nframes of a route's frames as they are, for a channel in
+ * the hardware format.  Returns the number of frames taken.
+ */
+static size_t
+kmixer_route_copy(struct kmixer_route *rt, uint8_t *dst, size_t nframes)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+	const size_t fsize = kmixer_frame_size(&ch->ch_pparams);
+	size_t off, len, done, n;
+	uint64_t cycles;
+	u_int head, tail;
+
+	head = rt->rt_head;
+	tail = ch->ch_rtail;
+	if (head == tail) {
+		rt->rt_got = 0;
+		return 0;
+	}
+
+	cycles = kmixer_cycles();
+	membar_consumer();
+	len = kmixer_ring_used(ch->ch_bufsize, head, tail);
+	len = MIN(len - len % fsize, nframes * fsize);
+
+	for (done = 0; done < len; done += n) {
+		off = kmixer_ring_off(ch->ch_bufsize, head);
+		n = MIN(len - done, ch->ch_bufsize - off);
+		memcpy(dst + done, ch->ch_buf + off, n);
+		head = kmixer_ring_adv(ch->ch_bufsize, head, n);
+	}
+
+	return kmixer_route_took(rt, head, len, cycles);
+}
+
+/*
+ * Count a route whose silence went into the mix as one underrun, until
+ * it has samples again.  Routes start out dry so that a channel yet to
+ * be written is not counted.
+ */
+static void
+kmixer_route_starve(struct kmixer_route *rt, bool starved)
+{
+	if (!starved)
+		rt->rt_dry = false;
+	else if (!rt->rt_dry) {
+		rt->rt_dry = true;
+		rt->rt_underruns++;
+		rt->rt_hw->hw_ev_underruns.ev_count++;
+	}
+}
+
+/*
+ * Wake a writer blocked on a full ring, and anyone waiting in poll or
+ * kqueue, once the low-water mark is free.  A waiter that raced with
+ * this check is seen next period.
+ */
+static void
+kmixer_chan_wake(struct kmixer_ch *ch)
+{
+	if ((ch->ch_wwait || ch->ch_pwait || ch->ch_nknotes > 0) &&
+	    kmixer_ring_free(ch) >= ch->ch_lowat) {
+		mutex_enter(&ch->ch_lock);
+		if (ch->ch_wwait)
+			cv_broadcast(&ch->ch_cv);
+		if (ch->ch_pwait || ch->ch_nknotes > 0) {
+			ch->ch_pwait = false;
+			selnotify(&ch->ch_wsel, POLLOUT | POLLWRNORM,
+			    NOTE_SUBMIT);
+		}
+		mutex_exit(&ch->ch_lock);
+	}
+}
+
+/*
+ * Sum a group's channels at their own rate, resample the sum once and add
+ * one period of it to the mix bus.  A channel that runs dry contributes
+ * silence for the rest of the period.
+ */
+static void
+kmixer_mix_group(struct kmixer_hw *hw, struct kmixer_pgroup *pg)
+{
+	const size_t sfsize = kmixer_frame_size(&pg->pg_sparams);
+	const size_t ofsize = kmixer_frame_size(&pg->pg_cparams);
+	const size_t period =
+	    hw->hw_blksize / kmixer_frame_size(&hw->hw_pparams);
+	struct kmixer_route *rt;
+	size_t n, room, nframes, got, need;
+	uint64_t cycles;
+
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	if (pg->pg_direct) {
+		/* already at the hardware rate and channels */
+		TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+			n = kmixer_route_sum(rt, hw->hw_mixbuf, period);
+			kmixer_route_starve(rt, n < period);
+		}
+		goto wake;
+	}
+
+	/* a device running fast takes the channels' samples slower */
+	if (pg->pg_steer)
+		kmixer_samplerate_set_drift(&pg->pg_ctx,
+		    -hw->hw_pclock.ck_drift);
+
+	need = period * ofsize;
+	while (pg->pg_cvtlen < need) {
+		/* input frames whose output is sure to fit in pg_cvtbuf */
+		room = (KMIXER_CVTSIZE - pg->pg_cvtlen) / ofsize;
+		if (room <= 3)
+			break;
+		nframes = room - 3 - (room >> KMIXER_SAMPLERATE_DRIFTSHIFT);
+		nframes = nframes * pg->pg_sparams.sample_rate /
+		    pg->pg_cparams.sample_rate;
+		nframes = MIN(nframes,
+		    KMIXER_SUMSAMPLES / pg->pg_sparams.channels);
+		if (nframes == 0)
+			break;
+
+		memset(pg->pg_sum, 0, nframes * sfsize);
+		got = 0;
+		TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+			got = MAX(got,
+			    kmixer_route_sum(rt, pg->pg_sum, nframes));
+		}
+		if (got == 0)
+			break;
+		/* a channel short of the others leaves a gap in the sum */
+		TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+			rt->rt_cvtframes += rt->rt_got;
+			kmixer_route_starve(rt, rt->rt_got < got);
+		}
+
+		cycles = kmixer_cycles();
+		pg->pg_cvtlen += kmixer_samplerate_play(&pg->pg_ctx,
+		    pg->pg_cvtbuf + pg->pg_cvtlen, (uint8_t *)pg->pg_sum,
+		    got * sfsize);
+		hw->hw_ev_cvtcycles.ev_count += kmixer_cycles() - cycles;
+	}
+	/* every channel is out of samples if the period is short */
+	if (pg->pg_cvtlen < need) {
+		TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry)
+			kmixer_route_starve(rt, true);
+	}
+
+	n = MIN(pg->pg_cvtlen, need);
+	kmixer_mix_bus(hw->hw_mixbuf, (const int32_t *)pg->pg_cvtbuf,
+	    n / sizeof(int32_t));
+	pg->pg_cvtlen -= n;
+	memmove(pg->pg_cvtbuf, pg->pg_cvtbuf + n, pg->pg_cvtlen);
+
+wake:
+	TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry)
+		kmixer_chan_wake(rt->rt_ch);
+}
+
+/*
+ * A lone channel playing the hardware format at unity gain is written to
+ * the device without going through the mix bus, see kmixer_mix_pass().
+ */
+static struct kmixer_route *
+kmixer_hw_passthrough(struct kmixer_hw *hw)
+{
+	struct kmixer_pgroup *pg = TAILQ_FIRST(&hw->hw_pgroups);
+	struct kmixer_route *rt;
+
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	if (pg == NULL || TAILQ_NEXT(pg, pg_entry) != NULL || !pg->pg_native)
+		return NULL;
+	rt = TAILQ_FIRST(&pg->pg_rt);
+	if (TAILQ_NEXT(rt, rt_pgentry) != NULL)
+		return NULL;
+	kmixer_route_gain(rt, true);
+	return kmixer_mix_unity(&rt->rt_ramp) ? rt : NULL;
+}
+
+/*
+ * Fill one period from a single route's ring, padding with silence if
+ * it runs dry.
+ */
+static void
+kmixer_mix_pass(struct kmixer_hw *hw, struct kmixer_route *rt)
+{
+	const audio_params_t *p = &hw->hw_pparams;
+	const size_t fsize = kmixer_frame_size(p);
+	const size_t period = hw->hw_blksize / fsize;
+	u_int nsamples;
+	size_t n;
+
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	n = kmixer_route_copy(rt, hw->hw_outbuf, period);
+	kmixer_route_starve(rt, n < period);
+	if (n < period) {
+		nsamples = (period - n) * p->channels;
+		memset(hw->hw_mixbuf, 0, nsamples * sizeof(*hw->hw_mixbuf));
+		kmixer_mix_out(hw->hw_outbuf + n * fsize, hw->hw_mixbuf, p,
+		    nsamples);
+	}
+	kmixer_chan_wake(rt->rt_ch);
+}
+
+/*
+ * Dither a mixed period for the device unless hw.kmixer.dither or
+ * hw.kmixer.nodither say otherwise.
+ */
+static void
+kmixer_hw_dither(struct kmixer_hw *hw, u_int nsamples)
+{
+	struct kmixer_softc *sc = hw->hw_softc;
+	const u_int mode = sc->sc_dither;
+
+	if (mode == KMIXER_DITHER_OFF ||
+	    (sc->sc_nodither & kmixer_hw_bit(hw)) != 0)
+		return;
+	hw->hw_dither.d_shape = mode == KMIXER_DITHER_SHAPED;
+	kmixer_mix_dither(hw->hw_mixbuf, &hw->hw_pparams, nsamples,
+	    &hw->hw_dither);
+}
+
+/*
+ * Track the rate a device runs at against nanouptime, from the times its
+ * periods of nframes complete.  This is a second order delay-locked
+ * loop: the time the next period should end is predicted from a
+ * filtered period and corrected by a fraction of each error, which in
+ * turn trims the period.  A device that stalls or changes period starts
+ * over, keeping the drift it had.
+ */
+static void
+kmixer_clock_update(struct kmixer_clock *ck, uint64_t now, size_t nframes,
+    u_int rate)
+{
+	int64_t nominal, e, diff;
+
+	if (ck->ck_frames != nframes) {
+		nominal = (uint64_t)nframes * 1000000000 / rate;
+		ck->ck_nominal = nominal << 16;
+		ck->ck_period = ck->ck_nominal;
+		ck->ck_b = KMIXER_CLOCK_OMEGA(nominal) * 14142 / 10000;
+		ck->ck_c = (KMIXER_CLOCK_OMEGA(nominal) *
+		    KMIXER_CLOCK_OMEGA(nominal)) >> 32;
+		ck->ck_next = now + nominal;
+		ck->ck_frames = nframes;
+		return;
+	}
+
+	e = (int64_t)(now - ck->ck_next);
+	if (e > ck->ck_nominal >> 16 || e < -(ck->ck_nominal >> 16)) {
+		ck->ck_frames = 0;
+		return;
+	}
+	ck->ck_next += ((ck->ck_b * e) >> 32) + (ck->ck_period >> 16);
+	ck->ck_period += (ck->ck_c * e) >> 16;
+
+	/* nominal / period - 1, with the difference kept in range first */
+	diff = ck->ck_nominal - ck->ck_period;
+	diff = MIN(MAX(diff, -(ck->ck_nominal >> KMIXER_SAMPLERATE_DRIFTSHIFT)),
+	    ck->ck_nominal >> KMIXER_SAMPLERATE_DRIFTSHIFT);
+	ck->ck_drift = (diff << 16) / (ck->ck_period >> 16);
+}
+
+/*
+ * Whether anything on a device is left to play: samples queued by a
+ * channel in a group, or already converted.
+ */
+static bool
+kmixer_hw_queued(struct kmixer_hw *hw)
+{
+	struct kmixer_pgroup *pg;
+	struct kmixer_route *rt;
+
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	TAILQ_FOREACH(pg, &hw->hw_pgroups, pg_entry) {
+		if (pg->pg_cvtlen > 0)
+			return true;
+		TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+			if (rt->rt_head != rt->rt_ch->ch_rtail)
+				return true;
+		}
+	}
+	return false;
+}
+
+static int
+kmixer_pause_hw(struct kmixer_hw *hw, bool pause)
+{
+	struct audio_info ai;
+
+	AUDIO_INITINFO(&ai);
+	ai.play.pause = pause;
+	return cdev_ioctl(hw->hw_audiodev, AUDIO_SETINFO, &ai,
+	    FREAD|FWRITE, &lwp0);
+}
+
+/*
+ * Stop mixing a device nothing has played on for hw.kmixer.idle: let
+ * the driver play out what it holds, pause it and sleep until a channel
+ * queues samples, see kmixer_chan_resume().  The device stays open, as
+ * drivers may take long to open again.  Called by the mixer thread.
+ */
+static void
+kmixer_hw_suspend(struct kmixer_hw *hw)
+{
+	struct kmixer_softc *sc = hw->hw_softc;
+	bool paused = false;
+
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	hw->hw_suspended = true;
+	atomic_inc_uint(&sc->sc_nsuspended);
+	/* either the writer sees hw_suspended or this sees its samples */
+	membar_sync();
+	if (!kmixer_hw_queued(hw)) {
+		hw->hw_busy = true;
+		mutex_exit(&hw->hw_lock);
+		(void)cdev_ioctl(hw->hw_audiodev, AUDIO_DRAIN, NULL,
+		    FREAD|FWRITE, &lwp0);
+		paused = kmixer_pause_hw(hw, true) == 0;
+		mutex_enter(&hw->hw_lock);
+		hw->hw_busy = false;
+		cv_broadcast(&hw->hw_cv);
+		hw->hw_ev_suspends.ev_count++;
+
+		while (hw->hw_open && !hw->hw_dying && !kmixer_hw_queued(hw))
+			cv_wait(&hw->hw_cv, &hw->hw_lock);
+	}
+	hw->hw_suspended = false;
+	atomic_dec_uint(&sc->sc_nsuspended);
+	hw->hw_idle = 0;
+	/* the clock starts over after the gap */
+	hw->hw_pclock.ck_frames = 0;
+
+	/* a device closed meanwhile is reopened unpaused */
+	if (paused && hw->hw_open && !hw->hw_dying) {
+		hw->hw_busy = true;
+		mutex_exit(&hw->hw_lock);
+		(void)kmixer_pause_hw(hw, false);
+		mutex_enter(&hw->hw_lock);
+		hw->hw_busy = false;
+		cv_broadcast(&hw->hw_cv);
+	}
+}
+
+/*
+ * One mixer thread runs per hardware device.  Each period it sums every
+ * play group into the mix bus, or copies the one channel playing the
+ * hardware format, and writes one block to the device; the device
+ * write blocks while the hardware ring is full, which paces the loop.
+ * A device left idle is suspended, see kmixer_hw_suspend().  Only
+ * hw_lock is held, so the threads of different devices mix in parallel.
+ */
+static void
+kmixer_mixer_thread(void *arg)
+{
+	struct kmixer_hw *hw = arg;
+	struct kmixer_pgroup *pg;
+	struct kmixer_route *rt;
+	uint64_t start, mixtime, cycles, cvtcycles;
+	u_int nsamples;
+	size_t n;
+	int err;
+
+	mutex_enter(&hw->hw_lock);
+	for (;;) {
+		while (!hw->hw_open && !hw->hw_dying)
+			cv_wait(&hw->hw_cv, &hw->hw_lock);
+		if (hw->hw_dying)
+			break;
+
+		SDT_PROBE1(kmixer, hw, mix, start, hw);
+		hw->hw_played = false;
+		start = kmixer_nsecs();
+		cycles = kmixer_cycles();
+		cvtcycles = hw->hw_ev_cvtcycles.ev_count;
+		if ((rt = kmixer_hw_passthrough(hw)) != NULL) {
+			kmixer_mix_pass(hw, rt);
+		} else {
+			nsamples = hw->hw_blksize /
+			    (hw->hw_pparams.precision / NBBY);
+			memset(hw->hw_mixbuf, 0,
+			    nsamples * sizeof(*hw->hw_mixbuf));
+			TAILQ_FOREACH(pg, &hw->hw_pgroups, pg_entry)
+				kmixer_mix_group(hw, pg);
+			kmixer_hw_dither(hw, nsamples);
+			kmixer_mix_out(hw->hw_outbuf, hw->hw_mixbuf,
+			    &hw->hw_pparams, nsamples);
+		}
+		hw->hw_ev_mixcycles.ev_count += kmixer_cycles() - cycles -
+		    (hw->hw_ev_cvtcycles.ev_count - cvtcycles);
+		mixtime = kmixer_nsecs() - start;
+		kmixer_hist_add(hw->hw_mixhist, mixtime);
+		if (mixtime / 1000 > kmixer_hw_period(hw))
+			hw->hw_ev_late.ev_count++;
+		SDT_PROBE2(kmixer, hw, mix, done, hw, mixtime);
+
+		hw->hw_busy = true;
+		mutex_exit(&hw->hw_lock);
+		SDT_PROBE2(kmixer, hw, write, start, hw, hw->hw_blksize);
+		err = kmixer_write_hw(hw);
+		SDT_PROBE2(kmixer, hw, write, done, hw, err);
+		mutex_enter(&hw->hw_lock);
+		hw->hw_busy = false;
+		cv_broadcast(&hw->hw_cv);
+		if (hw->hw_latmarks > 0)
+			kmixer_lat_done(hw, err);
+
+		if (err) {
+			printf("kmixer: %s: write error %d\n",
+			    kmixer_hw_devname(hw), err);
+			hw->hw_pclock.ck_frames = 0;
+			(void)cv_timedwait(&hw->hw_cv, &hw->hw_lock, hz);
+		} else {
+			n = hw->hw_blksize / kmixer_frame_size(&hw->hw_pparams);
+			hw->hw_ev_frames.ev_count += n;
+			kmixer_clock_update(&hw->hw_pclock, kmixer_nsecs(), n,
+			    hw->hw_pparams.sample_rate);
+		}
+
+		if (hw->hw_played)
+			hw->hw_idle = 0;
+		else if (hw->hw_idle / 1000 < hw->hw_softc->sc_idle)
+			hw->hw_idle += kmixer_hw_period(hw);
+		else if (hw->hw_softc->sc_idle != 0)
+			kmixer_hw_suspend(hw);
+	}
+	mutex_exit(&hw->hw_lock);
+
+	kthread_exit(0);
+}
+
+static int
+kmixer_read_hw(struct kmixer_hw *hw, size_t *lenp)
+{
+	struct iovec iov;
+	struct uio uio;
+	int err;
+
+	iov.iov_base = hw->hw_inbuf;
+	iov.iov_len = hw->hw_blksize;
+	uio.uio_iov = &iov;
+	uio.uio_iovcnt = 1;
+	uio.uio_offset = 0;
+	uio.uio_resid = hw->hw_blksize;
+	uio.uio_rw = UIO_READ;
+	UIO_SETUP_SYSSPACE(&uio);
+
+	err = cdev_read(hw->hw_audiodev, &uio, 0);
+	*lenp = hw->hw_blksize - uio.uio_resid;
+
+	return err;
+}
+
+static void
+kmixer_rgroup_free(struct kmixer_rgroup *rg)
+{
+	size_t nframes = rg->rg_cvtsize / kmixer_frame_size(&rg->rg_cparams);
+
+	kmixer_samplerate_destroy_context(&rg->rg_ctx);
+	if (rg->rg_buf != rg->rg_cvtbuf) {
+		kmem_free(rg->rg_buf, rg->rg_bufsize);
+		kmem_free(rg->rg_bus, nframes * rg->rg_params.channels *
+		    sizeof(int32_t));
+	}
+	kmem_free(rg->rg_cvtbuf, rg->rg_cvtsize);
+	kmem_free(rg, sizeof(*rg));
+}
+
+/*
+ * Find or create the group recording a format on a device.  Returns NULL
+ * if the converter cannot produce it.
+ */
+static struct kmixer_rgroup *
+kmixer_rgroup_get(struct kmixer_hw *hw, const audio_params_t *p,
+    int quality)
+{
+	struct kmixer_rgroup *rg;
+	size_t nframes;
+
+	KASSERT(mutex_owned(&hw->hw_softc->sc_lock));
+	KASSERT(mutex_owned(&hw->hw_lock));
+
+	TAILQ_FOREACH(rg, &hw->hw_rgroups, rg_entry) {
+		if (rg->rg_quality == quality &&
+		    memcmp(&rg->rg_params, p, sizeof(*p)) == 0)
+			return rg;
+	}
+
+	rg = kmem_zalloc(sizeof(*rg), KM_SLEEP);
+	rg->rg_hw = hw;
+	TAILQ_INIT(&rg->rg_ch);
+	rg->rg_params = *p;
+	rg->rg_quality = quality;
+	rg->rg_cparams = hw->hw_rparams;
+	rg->rg_cparams.sample_rate = p->sample_rate;
+	rg->rg_cparams.channels = p->channels;
+
+	rg->rg_steer = kmixer_steer(hw->hw_softc, p->sample_rate,
+	    hw->hw_rparams.sample_rate);
+
+	/* output frames of the largest period */
+	nframes = kmixer_samplerate_maxout(hw->hw_rparams.sample_rate,
+	    p->sample_rate,
+	    KMIXER_MAXBLKSIZE / kmixer_frame_size(&hw->hw_rparams));
+	rg->rg_cvtsize = nframes * kmixer_frame_size(&rg->rg_cparams);
+	rg->rg_cvtbuf = kmem_alloc(rg->rg_cvtsize, KM_SLEEP);
+	if (p->encoding == rg->rg_cparams.encoding &&
+	    p->precision == rg->rg_cparams.precision) {
+		rg->rg_buf = rg->rg_cvtbuf;
+	} else {
+		rg->rg_bufsize = nframes * kmixer_frame_size(p);
+		rg->rg_buf = kmem_alloc(rg->rg_bufsize, KM_SLEEP);
+		rg->rg_bus = kmem_alloc(nframes * p->channels *
+		    sizeof(int32_t), KM_SLEEP);
+	}
+
+	if (kmixer_samplerate_init_context(&rg->rg_ctx, &hw->hw_rparams,
+	    &rg->rg_cparams, quality, rg->rg_steer, hw->hw_inbuf,
+	    hw->hw_inbuf + KMIXER_MAXBLKSIZE) != 0) {
+		kmixer_rgroup_free(rg);
+		return NULL;
+	}
+
+	/* the capture thread idles while no format is being recorded */
+	if (TAILQ_EMPTY(&hw->hw_rgroups))
+		cv_broadcast(&hw->hw_cv);
+	TAILQ_INSERT_TAIL(&hw->hw_rgroups, rg, rg_entry);
+
+	return rg;
+}
+
+/*
+ * Convert a captured block to a group's format: rate and channels
+ * first, in the hardware encoding, then through the mix bus to the
+ * client encoding if it differs.
+ */
+static void
+kmixer_capture_group(struct kmixer_hw *hw, struct kmixer_rgroup *rg,
+    size_t len)
+{
+	const audio_params_t *p = &rg->rg_params;
+	uint64_t cycles;
+	u_int nsamples;
+	int n;
+
+	cycles = kmixer_cycles();
+	n = kmixer_samplerate_record(&rg->rg_ctx, rg->rg_cvtbuf,
+	    hw->hw_inbuf, len);
+	if (rg->rg_buf == rg->rg_cvtbuf) {
+		rg->rg_len = n;
+	} else {
+		nsamples = n / (rg->rg_cparams.precision / NBBY);
+		memset(rg->rg_bus, 0, nsamples * sizeof(*rg->rg_bus));
+		kmixer_mix_add(rg->rg_bus, rg->rg_cvtbuf, &rg->rg_cparams,
+		    nsamples);
+		kmixer_mix_out(rg->rg_buf, rg->rg_bus, p, nsamples);
+		rg->rg_len = nsamples * (p->precision / NBBY);
+	}
+	hw->hw_ev_cvtcycles.ev_count += kmixer_cycles() - cycles;
+}
+
+/*
+ * Queue a group's converted block on a recording channel.  A reader
+ * that falls behind loses the newest samples.
+ */
+static void
+kmixer_capture_chan(struct kmixer_ch *ch)
+{
+	const struct kmixer_rgroup *rg = ch->ch_recgroup;
+	const size_t fsize = kmixer_frame_size(&rg->rg_params);
+	size_t off, n, len, done;
+	u_int head, tail;
+
+	head = ch->ch_rechead;
+	tail = ch->ch_rectail;
+	membar_consumer();
+	len = ch->ch_recsize - kmixer_ring_used(ch->ch_recsize, head, tail);
+	len = MIN(len, rg->rg_len);
+	len -= len % fsize;
+
+	for (done = 0; done < len; done += n) {
+		off = kmixer_ring_off(ch->ch_recsize, tail);
+		n = MIN(len - done, ch->ch_recsize - off);
+		memcpy(ch->ch_recbuf + off, rg->rg_buf + done, n);
+		tail = kmixer_ring_adv(ch->ch_recsize, tail, n);
+	}
+
+	/* samples are visible before the reader sees the new tail */
+	membar_producer();
+	ch->ch_rectail = tail;
+
+	ch->ch_recframes += len / fsize;
+	if (len < rg->rg_len) {
+		ch->ch_overruns++;
+		rg->rg_hw->hw_ev_overruns.ev_count++;
+	}
+
+	/* as in kmixer_chan_wake(), a racing waiter is seen next period */
+	if (len > 0 && (ch->ch_recwait || ch->ch_recpwait ||
+	    ch->ch_recnknotes > 0)) {
+		mutex_enter(&ch->ch_lock);
+		if (ch->ch_recwait)
+			cv_broadcast(&ch->ch_cv);
+		if (ch->ch_recpwait || ch->ch_recnknotes > 0) {
+			ch->ch_recpwait = false;
+			selnotify(&ch->ch_recsel, POLLIN | POLLRDNORM,
+			    NOTE_SUBMIT);
+		}
+		mutex_exit(&ch->ch_lock);
+	}
+}
+
+/*
+ * The capture thread reads one block at a time from the device while
+ * any channel records from it, converts the block once per recorded
+ * format and hands the result to every channel asking for that format.
+ */
+static void
+kmixer_capture_thread(void *arg)
+{
+	struct kmixer_hw *hw = arg;
+	struct kmixer_rgroup *rg;
+	struct kmixer_ch *ch;
+	size_t len;
+	int err;
+
+	mutex_enter(&hw->hw_lock);
+	for (;;) {
+		while ((!hw->hw_open || TAILQ_EMPTY(&hw->hw_rgroups)) &&
+		    !hw->hw_dying)
+			cv_wait(&hw->hw_cv, &hw->hw_lock);
+		if (hw->hw_dying)
+			break;
+
+		hw->hw_rbusy = true;
+		mutex_exit(&hw->hw_lock);
+		err = kmixer_read_hw(hw, &len);
+		mutex_enter(&hw->hw_lock);
+		hw->hw_rbusy = false;
+		cv_broadcast(&hw->hw_cv);
+
+		if (err) {
+			printf("kmixer: %s: read error %d\n",
+			    kmixer_hw_devname(hw), err);
+			hw->hw_rclock.ck_frames = 0;
+			(void)cv_timedwait(&hw->hw_cv, &hw->hw_lock, hz);
+			continue;
+		}
+
+		len -= len % kmixer_frame_size(&hw->hw_rparams);
+		hw->hw_ev_recframes.ev_count +=
+		    len / kmixer_frame_size(&hw->hw_rparams);
+		kmixer_clock_update(&hw->hw_rclock, kmixer_nsecs(),
+		    len / kmixer_frame_size(&hw->hw_rparams),
+		    hw->hw_rparams.sample_rate);
+		TAILQ_FOREACH(rg, &hw->hw_rgroups, rg_entry) {
+			/* a device running fast gives the channels more */
+			if (rg->rg_steer)
+				kmixer_samplerate_set_drift(&rg->rg_ctx,
+				    hw->hw_rclock.ck_drift);
+			kmixer_capture_group(hw, rg, len);
+			TAILQ_FOREACH(ch, &rg->rg_ch, ch_recentry)
+				kmixer_capture_chan(ch);
+		}
+	}
+	mutex_exit(&hw->hw_lock);
+
+	kthread_exit(0);
+}
+
+static void
+kmixer_devicehook(void *arg, device_t dev, int event)
+{
+	struct kmixer_softc *sc = arg;
+
+	if (!device_is_a(dev, "audio"))
+		return;
+
+	mutex_enter(&sc->sc_lock);
+
+	switch (event) {
+	case DEVICE_ATTACHED:
+		kmixer_add_hw(sc, dev);
+		break;
+	case DEVICE_DETACHED:
+		kmixer_del_hw(sc, dev);
+		break;
+	}
+
+	kmixer_select_hw(sc);
+
+	/* opening the new device and joining threads can take a while */
+	kmixer_migrate_kick(sc);
+
+	mutex_exit(&sc->sc_lock);
+}
+
+static bool
+kmixer_chan_wants(struct kmixer_ch *ch, struct kmixer_hw *hw)
+{
+	if (ch->ch_route == 0)
+		return hw == ch->ch_softc->sc_selhw;
+	return (ch->ch_route & kmixer_hw_bit(hw)) != 0;
+}
+
+static bool
+kmixer_hw_wanted(struct kmixer_softc *sc, struct kmixer_hw *hw)
+{
+	struct kmixer_ch *ch;
+
+	TAILQ_FOREACH(ch, &sc->sc_ch, ch_entry) {
+		if (kmixer_chan_wants(ch, hw))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Open the devices that channels want to play on.  kmixer_open_hw()
+ * sleeps without sc_lock, so give up if the device list changed
+ * meanwhile; the devicehook has kicked the thread again.
+ */
+static bool
+kmixer_migrate_open(struct kmixer_softc *sc)
+{
+	struct kmixer_hw *hw;
+	u_int gen = sc->sc_hwgen;
+	int err;
+
+	TAILQ_FOREACH(hw, &sc->sc_hw, hw_entry) {
+		if (hw->hw_open || !kmixer_hw_wanted(sc, hw))
+			continue;
+		err = kmixer_open_hw(sc, hw);
+		if (err)
+			printf("kmixer: %s: couldn't open (%d)\n",
+			    kmixer_hw_devname(hw), err);
+		if (sc->sc_hwgen != gen)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Move a play group and its routes to another device as a whole, so its
+ * converter carries on where it stopped.
+ */
+static void
+kmixer_pgroup_move(struct kmixer_pgroup *pg, struct kmixer_hw *to)
+{
+	struct kmixer_hw *from = pg->pg_hw;
+	struct kmixer_route *rt;
+
+	KASSERT(mutex_owned(&from->hw_softc->sc_lock));
+
+	mutex_enter(&from->hw_lock);
+	TAILQ_REMOVE(&from->hw_pgroups, pg, pg_entry);
+	TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+		/* from's mixer is done with the samples, untime them */
+		kmixer_lat_clear(rt);
+		TAILQ_REMOVE(&from->hw_routes, rt, rt_entry);
+	}
+	mutex_exit(&from->hw_lock);
+
+	mutex_enter(&to->hw_lock);
+	pg->pg_hw = to;
+	TAILQ_INSERT_TAIL(&to->hw_pgroups, pg, pg_entry);
+	TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+		rt->rt_hw = to;
+		TAILQ_INSERT_TAIL(&to->hw_routes, rt, rt_entry);
+	}
+	mutex_exit(&to->hw_lock);
+
+	/* the same hardware format takes the same client formats */
+	TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry)
+		kmixer_chan_rehome(rt->rt_ch, from);
+}
+
+/*
+ * Channels following the selected device have a single route each.
+ * Move their play groups over whole when the selected device plays the
+ * same format and has no such group yet.
+ */
+static void
+kmixer_migrate_groups(struct kmixer_softc *sc)
+{
+	struct kmixer_hw *to = sc->sc_selhw, *hw;
+	struct kmixer_pgroup *pg, *npg;
+	struct kmixer_route *rt;
+
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	if (to == NULL || !to->hw_open)
+		return;
+
+	TAILQ_FOREACH(hw, &sc->sc_hw, hw_entry) {
+		if (hw == to || memcmp(&hw->hw_pparams, &to->hw_pparams,
+		    sizeof(hw->hw_pparams)) != 0)
+			continue;
+		TAILQ_FOREACH_SAFE(pg, &hw->hw_pgroups, pg_entry, npg) {
+			TAILQ_FOREACH(rt, &pg->pg_rt, rt_pgentry) {
+				if (rt->rt_ch->ch_route != 0)
+					break;
+			}
+			if (rt == NULL && kmixer_pgroup_find(to,
+			    &pg->pg_params, pg->pg_quality) == NULL)
+				kmixer_pgroup_move(pg, to);
+		}
+	}
+}
+
+/*
+ * Open the devices channels want, route every channel to them, close
+ * what is left unused and set the formats and periods of the others.
+ * Runs in its own thread so that kmixer_devicehook() never waits for a
+ * device to open, and reaps removed devices on the way.
+ */
+static void
+kmixer_migrate_thread(void *arg)
+{
+	struct kmixer_softc *sc = arg;
+	struct kmixer_hw *hw;
+	struct kmixer_ch *ch;
+
+	mutex_enter(&sc->sc_lock);
+	for (;;) {
+		while (!sc->sc_migrate && !sc->sc_dying)
+			cv_wait(&sc->sc_cv, &sc->sc_lock);
+		if (sc->sc_dying)
+			break;
+		sc->sc_migrate = false;
+
+		mutex_exit(&sc->sc_lock);
+		kmixer_reap_hw(sc);
+		mutex_enter(&sc->sc_lock);
+
+		/* streams keep playing on their old devices meanwhile */
+		if (!kmixer_migrate_open(sc))
+			continue;
+
+		kmixer_migrate_groups(sc);
+		TAILQ_FOREACH(ch, &sc->sc_ch, ch_entry)
+			kmixer_chan_route(ch);
+		TAILQ_FOREACH(hw, &sc->sc_hw, hw_entry) {
+			kmixer_close_hw(sc, hw);
+			kmixer_format_hw(sc, hw);
+			kmixer_period_hw(sc, hw);
+		}
+	}
+	mutex_exit(&sc->sc_lock);
+
+	kthread_exit(0);
+}
+
+static int
+kmixer_sysctl_period(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	struct kmixer_softc *sc = node.sysctl_data;
+	int t, err;
+
+	t = sc->sc_period;
+	node.sysctl_data = &t;
+	err = sysctl_lookup(SYSCTLFN_CALL(&node));
+	if (err || newp == NULL)
+		return err;
+	if (t < 0)
+		return EINVAL;
+
+	mutex_enter(&sc->sc_lock);
+	sc->sc_period = t ? MAX(t, KMIXER_MINPERIOD) : 0;
+	kmixer_migrate_kick(sc);
+	mutex_exit(&sc->sc_lock);
+
+	return 0;
+}
+
+static int
+kmixer_sysctl_drift(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	struct kmixer_softc *sc = node.sysctl_data;
+	int t, err;
+
+	t = sc->sc_drift;
+	node.sysctl_data = &t;
+	err = sysctl_lookup(SYSCTLFN_CALL(&node));
+	if (err || newp == NULL)
+		return err;
+	if (t < KMIXER_DRIFT_OFF || t > KMIXER_DRIFT_ALL)
+		return EINVAL;
+
+	/* taken by groups as they are created */
+	mutex_enter(&sc->sc_lock);
+	sc->sc_drift = t;
+	mutex_exit(&sc->sc_lock);
+
+	return 0;
+}
+
+static int
+kmixer_sysctl_rate(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	struct kmixer_softc *sc = node.sysctl_data;
+	int t, err;
+
+	t = sc->sc_rate;
+	node.sysctl_data = &t;
+	err = sysctl_lookup(SYSCTLFN_CALL(&node));
+	if (err || newp == NULL)
+		return err;
+	if (t < KMIXER_RATE_FIXED || t > KMIXER_RATE_MAJORITY)
+		return EINVAL;
+
+	mutex_enter(&sc->sc_lock);
+	sc->sc_rate = t;
+	kmixer_migrate_kick(sc);
+	mutex_exit(&sc->sc_lock);
+
+	return 0;
+}
+
+static int
+kmixer_sysctl_idle(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	struct kmixer_softc *sc = node.sysctl_data;
+	int t, err;
+
+	t = sc->sc_idle;
+	node.sysctl_data = &t;
+	err = sysctl_lookup(SYSCTLFN_CALL(&node));
+	if (err || newp == NULL)
+		return err;
+	if (t < 0 || t > KMIXER_IDLE_MAX)
+		return EINVAL;
+
+	/* seen by the mixers next period */
+	sc->sc_idle = t;
+
+	return 0;
+}
+
+static int
+kmixer_sysctl_dither(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	struct kmixer_softc *sc = node.sysctl_data;
+	int t, err;
+
+	t = sc->sc_dither;
+	node.sysctl_data = &t;
+	err = sysctl_lookup(SYSCTLFN_CALL(&node));
+	if (err || newp == NULL)
+		return err;
+	if (t < KMIXER_DITHER_OFF || t > KMIXER_DITHER_SHAPED)
+		return EINVAL;
+
+	/* seen by the mixers next period */
+	sc->sc_dither = t;
+
+	return 0;
+}
+
+static int
+kmixer_sysctl_bufsize(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	struct kmixer_softc *sc = node.sysctl_data;
+	int t, err;
+
+	t = sc->sc_bufsize;
+	node.sysctl_data = &t;
+	err = sysctl_lookup(SYSCTLFN_CALL(&node));
+	if (err || newp == NULL)
+		return err;
+	if (t < 0)
+		return EINVAL;
+
+	/* taken by channels as they are opened or reset */
+	mutex_enter(&sc->sc_lock);
+	sc->sc_bufsize = t;
+	mutex_exit(&sc->sc_lock);
+
+	return 0;
+}
+
+/*
+ * hw.kmixer: the nodes are created and destroyed without sc_lock held,
+ * as the handlers take it.
+ */
+static void
+kmixer_sysctl_setup(struct kmixer_softc *sc)
+{
+	const struct sysctlnode *node;
+
+	if (sysctl_createv(&sc->sc_sysctllog, 0, NULL, &node,
+	    CTLFLAG_PERMANENT, CTLTYPE_NODE, "kmixer",
+	    SYSCTL_DESCR("kernel audio mixer"),
+	    NULL, 0, NULL, 0, CTL_HW, CTL_CREATE, CTL_EOL) != 0)
+		return;
+	sc->sc_sysctlnode = node;
+
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "period",
+	    SYSCTL_DESCR("Longest mixer period in microseconds, "
+	    "0 for the driver's block size"),
+	    kmixer_sysctl_period, 0, (void *)sc, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "bufsize",
+	    SYSCTL_DESCR("Default channel ring size in bytes, "
+	    "0 for the largest"),
+	    kmixer_sysctl_bufsize, 0, (void *)sc, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "drift",
+	    SYSCTL_DESCR("Follow device clock drift: 0 never, "
+	    "1 when resampling anyway, 2 always"),
+	    kmixer_sysctl_drift, 0, (void *)sc, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "rate",
+	    SYSCTL_DESCR("Device sample rate: 0 fixed, 1 the first "
+	    "channel's, 2 the one most channels play"),
+	    kmixer_sysctl_rate, 0, (void *)sc, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "idle",
+	    SYSCTL_DESCR("Milliseconds a device plays nothing before it is "
+	    "paused, 0 never"),
+	    kmixer_sysctl_idle, 0, (void *)sc, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "dither",
+	    SYSCTL_DESCR("Dither output narrower than the mix: 0 off, "
+	    "1 TPDF, 2 TPDF with noise shaping"),
+	    kmixer_sysctl_dither, 0, (void *)sc, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(&sc->sc_sysctllog, 0, &node, NULL,
+	    CTLFLAG_PERMANENT | CTLFLAG_READWRITE, CTLTYPE_INT, "nodither",
+	    SYSCTL_DESCR("Devices never dithered, bit n for audio n"),
+	    NULL, 0, &sc->sc_nodither, 0, CTL_CREATE, CTL_EOL);
+}
+
+/*
+ * A route counter summed over the channel's routes; the offset of the
+ * counter in struct kmixer_route is in the node's sysctl_idata.  The
+ * sum is not locked, it may be a period out of date.
+ */
+static int
+kmixer_sysctl_route(SYSCTLFN_ARGS)
+{
+	struct sysctlnode node = *rnode;
+	const struct kmixer_ch *ch = node.sysctl_data;
+	const size_t off = node.sysctl_idata;
+	uint64_t sum = 0;
+	int i;
+
+	for (i = 0; i < KMIXER_MAXROUTES; i++)
+		sum += *(const uint64_t *)((const char *)&ch->ch_rt[i] + off);
+	node.sysctl_data = &sum;
+
+	return sysctl_lookup(SYSCTLFN_CALL(&node));
+}
+
+/*
+ * hw.kmixer.ch<serial> for the life of an open channel.  Must be called
+ * without sc_lock held, see kmixer_sysctl_setup().
+ */
+static void
+kmixer_chan_sysctl_setup(struct kmixer_ch *ch)
+{
+	struct kmixer_softc *sc = ch->ch_softc;
+	const struct sysctlnode *node;
+	struct sysctllog **log = &ch->ch_sysctllog;
+	const int flags = CTLFLAG_PERMANENT | CTLFLAG_READONLY;
+	char name[16];
+
+	if (sc->sc_sysctlnode == NULL)
+		return;
+
+	snprintf(name, sizeof(name), "ch%u", ch->ch_serial);
+	if (sysctl_createv(log, 0, &sc->sc_sysctlnode, &node,
+	    CTLFLAG_PERMANENT, CTLTYPE_NODE, name,
+	    SYSCTL_DESCR("open channel"),
+	    NULL, 0, NULL, 0, CTL_CREATE, CTL_EOL) != 0)
+		return;
+
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_INT, "pid",
+	    SYSCTL_DESCR("Process that opened the channel"),
+	    NULL, 0, &ch->ch_pid, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "written",
+	    SYSCTL_DESCR("Frames queued by the process"),
+	    NULL, 0, &ch->ch_wframes, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "blocked",
+	    SYSCTL_DESCR("Writes that waited for room"),
+	    NULL, 0, &ch->ch_wblocked, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "mixed",
+	    SYSCTL_DESCR("Frames mixed, summed over devices"),
+	    kmixer_sysctl_route, offsetof(struct kmixer_route, rt_frames),
+	    ch, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "resampled",
+	    SYSCTL_DESCR("Frames mixed through a rate converter"),
+	    kmixer_sysctl_route, offsetof(struct kmixer_route, rt_cvtframes),
+	    ch, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "underruns",
+	    SYSCTL_DESCR("Times a device ran out of samples"),
+	    kmixer_sysctl_route, offsetof(struct kmixer_route, rt_underruns),
+	    ch, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "cycles",
+	    SYSCTL_DESCR("CPU cycles spent mixing the channel"),
+	    kmixer_sysctl_route, offsetof(struct kmixer_route, rt_cycles),
+	    ch, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "recorded",
+	    SYSCTL_DESCR("Frames queued for the process"),
+	    NULL, 0, &ch->ch_recframes, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_QUAD, "overruns",
+	    SYSCTL_DESCR("Recorded blocks cut short by a full ring"),
+	    NULL, 0, &ch->ch_overruns, 0, CTL_CREATE, CTL_EOL);
+	sysctl_createv(log, 0, &node, NULL, flags, CTLTYPE_STRUCT, "latency",
+	    SYSCTL_DESCR("Queue to device write histogram, "
+	    "see KMIXER_GETLATENCY"),
+	    NULL, 0, ch->ch_lathist, sizeof(ch->ch_lathist),
+	    CTL_CREATE, CTL_EOL);
+}
+
+/*
+ * The client ring lives in an anonymous object so that kmixer_chan_mmap()
+ * can hand the same pages to the process.  The kernel mapping is wired:
+ * each mixer thread reads it holding only its device's hw_lock, and the
+ * writer and the routes share it through the lock-free head and tail
+ * indices, see kmixer_chan_head().
+ */
+static int
+kmixer_alloc_ring(struct kmixer_ch *ch)
+{
+	vaddr_t va = 0;
+	int err;
+
+	ch->ch_uobj = uao_create(KMIXER_BUFMAPSIZE, 0);
+	err = uvm_map(kernel_map, &va, KMIXER_BUFMAPSIZE, ch->ch_uobj, 0, 0,
+	    UVM_MAPFLAG(UVM_PROT_RW, UVM_PROT_RW, UVM_INH_NONE,
+	    UVM_ADV_RANDOM, 0));
+	if (err) {
+		uao_detach(ch->ch_uobj);
+		ch->ch_uobj = NULL;
+		return err;
+	}
+	err = uvm_map_pageable(kernel_map, va, va + KMIXER_BUFMAPSIZE,
+	    false, 0);
+	if (err) {
+		/* drops the reference to ch_uobj too */
+		uvm_unmap(kernel_map, va, va + KMIXER_BUFMAPSIZE);
+		ch->ch_uobj = NULL;
+		return err;
+	}
+	ch->ch_buf = (uint8_t *)va;
+
+	return 0;
+}
+
+static void
+kmixer_free_ring(struct kmixer_ch *ch)
+{
+	vaddr_t va = (vaddr_t)ch->ch_buf;
+
+	/* process mappings keep their own reference to ch_uobj */
+	uvm_unmap(kernel_map, va, va + KMIXER_BUFMAPSIZE);
+	ch->ch_buf = NULL;
+	ch->ch_uobj = NULL;
+}
+
+/*
+ * Channels come from sc_chcache.  The constructor sets up the locks, the
+ * ring and the record buffer once, so that open and close only reset the
+ * per-open state below.
+ */
+static int
+kmixer_chan_ctor(void *arg, void *obj, int flags)
+{
+	struct kmixer_ch *ch = obj;
+	int err, i;
+
+	memset(ch, 0, sizeof(*ch));
+	ch->ch_softc = arg;
+	for (i = 0; i < KMIXER_MAXROUTES; i++)
+		ch->ch_rt[i].rt_ch = ch;
+	err = kmixer_alloc_ring(ch);
+	if (err)
+		return err;
+	ch->ch_recbuf = kmem_alloc(KMIXER_BUFSIZE, KM_SLEEP);
+	cv_init(&ch->ch_cv, "kmixerch");
+	mutex_init(&ch->ch_lock, MUTEX_DEFAULT, IPL_AUDIO);
+	mutex_init(&ch->ch_wlock, MUTEX_DEFAULT, IPL_NONE);
+	mutex_init(&ch->ch_reclock, MUTEX_DEFAULT, IPL_NONE);
+	selinit(&ch->ch_wsel);
+	selinit(&ch->ch_recsel);
+
+	return 0;
+}
+
+static void
+kmixer_chan_dtor(void *arg, void *obj)
+{
+	struct kmixer_ch *ch = obj;
+
+	seldestroy(&ch->ch_recsel);
+	seldestroy(&ch->ch_wsel);
+	mutex_destroy(&ch->ch_reclock);
+	mutex_destroy(&ch->ch_wlock);
+	mutex_destroy(&ch->ch_lock);
+	cv_destroy(&ch->ch_cv);
+	kmem_free(ch->ch_recbuf, KMIXER_BUFSIZE);
+	kmixer_free_ring(ch);
+}
+
+static struct kmixer_ch *
+kmixer_alloc_chan(struct kmixer_softc *sc, int mode)
+{
+	struct kmixer_route *rt;
+	struct kmixer_hw *hw;
+	struct kmixer_ch *ch;
+	int i, err = 0;
+
+	ch = pool_cache_get(sc->sc_chcache, PR_WAITOK);
+	if (ch == NULL)
+		return NULL;
+
+	KASSERT(ch->ch_rtmask == 0 && ch->ch_recgroup == NULL);
+	KASSERT(ch->ch_nknotes == 0 && ch->ch_recnknotes == 0);
+	/*
+	 * A cached channel still holds the samples of its last open, which
+	 * kmixer_chan_mmap() would show the process.  Nothing reads the
+	 * ring until the channel is routed below.
+	 */
+	memset(ch->ch_buf, 0, KMIXER_BUFMAPSIZE);
+	ch->ch_mode = mode;
+	ch->ch_route = 0;
+	ch->ch_pparams = kmixer_ch_default;
+	ch->ch_recparams = kmixer_ch_default;
+	ch->ch_quality = KMIXER_QUALITY_DEFAULT;
+	ch->ch_gainreq.gain = KMIXER_GAIN_UNITY;
+	ch->ch_gainreq.pan = 0;
+	ch->ch_gainreq.mute = 0;
+	for (i = 0; i < __arraycount(ch->ch_gain); i++)
+		ch->ch_gain[i] = KMIXER_GAIN_UNITY;
+	ch->ch_gaingen = 0;
+	ch->ch_lowatreq = 0;
+	ch->ch_bufreq = 0;
+	ch->ch_periodreq = 0;
+	ch->ch_wwait = false;
+	ch->ch_pwait = false;
+	ch->ch_recwait = false;
+	ch->ch_recpwait = false;
+	ch->ch_mapped = false;
+	ch->ch_pid = curproc->p_pid;
+	ch->ch_wframes = ch->ch_wblocked = 0;
+	ch->ch_recframes = ch->ch_overruns = 0;
+	memset(ch->ch_lathist, 0, sizeof(ch->ch_lathist));
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		rt = &ch->ch_rt[i];
+		rt->rt_frames = rt->rt_cvtframes = 0;
+		rt->rt_underruns = rt->rt_cycles = 0;
+	}
+
+	mutex_enter(&sc->sc_lock);
+	ch->ch_serial = sc->sc_chserial++;
+	kmixer_chan_reset(ch);
+	kmixer_chan_rec_reset(ch);
+	TAILQ_INSERT_TAIL(&sc->sc_ch, ch, ch_entry);
+	hw = sc->sc_selhw;
+	if (hw) {
+		err = kmixer_open_hw(sc, hw);
+		if (err == 0) {
+			kmixer_chan_route(ch);
+			/* the selection may have changed while hw opened */
+			if (hw != sc->sc_selhw)
+				kmixer_migrate_kick(sc);
+		}
+	}
+	mutex_exit(&sc->sc_lock);
+
+	if (err) {
+		/* the migration thread may have routed it meanwhile */
+		kmixer_free_chan(ch);
+		return NULL;
+	}
+	kmixer_chan_sysctl_setup(ch);
+
+	return ch;
+}
+
+static void
+kmixer_free_chan(struct kmixer_ch *ch)
+{
+	struct kmixer_softc *sc = ch->ch_softc;
+	struct kmixer_hw *hw;
+	int i;
+
+	sysctl_teardown(&ch->ch_sysctllog);
+
+	mutex_enter(&sc->sc_lock);
+	kmixer_chan_rec_leave(ch);
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		hw = ch->ch_rt[i].rt_hw;
+		if (hw != NULL) {
+			kmixer_route_del(&ch->ch_rt[i]);
+			kmixer_close_hw(sc, hw);
+		}
+	}
+	TAILQ_REMOVE(&sc->sc_ch, ch, ch_entry);
+	/* the devices may go back to a longer period or another format */
+	kmixer_migrate_kick(sc);
+	mutex_exit(&sc->sc_lock);
+
+	/*
+	 * A process may keep its mapping of the ring after close, so a
+	 * mapped channel must not carry its pages to the next open.
+	 */
+	if (ch->ch_mapped)
+		pool_cache_destruct_object(sc->sc_chcache, ch);
+	else
+		pool_cache_put(sc->sc_chcache, ch);
+}
+
+/*
+ * The device a channel records from and whose formats it is checked
+ * against: the one in its first route.
+ */
+static struct kmixer_hw *
+kmixer_chan_hw(struct kmixer_ch *ch)
+{
+	int i;
+
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		if (ch->ch_rt[i].rt_hw != NULL)
+			return ch->ch_rt[i].rt_hw;
+	}
+	return NULL;
+}
+
+static const audio_params_t *
+kmixer_chan_hwparams(struct kmixer_ch *ch)
+{
+	struct kmixer_hw *hw = kmixer_chan_hw(ch);
+
+	return hw ? &hw->hw_pparams : &kmixer_hw_default;
+}
+
+/*
+ * Check that the mixer can take a play format to a hardware format:
+ * both must go to and from the mix bus, and the converter must take the
+ * bus from the play rate and channels to the hardware's, see
+ * kmixer_mix_group().
+ */
+static int
+kmixer_check_params(const audio_params_t *hwp, const audio_params_t *p)
+{
+	audio_params_t sp, cp;
+
+	if (p->sample_rate == 0 || p->channels == 0 ||
+	    p->channels > AUDIO_MAX_CHANNELS)
+		return EINVAL;
+	if (kmixer_mix_check_params(hwp) != 0)
+		return EINVAL;
+	if (kmixer_mix_check_params(p) != 0)
+		return EINVAL;
+
+	kmixer_bus_params(p, &sp);
+	kmixer_bus_params(hwp, &cp);
+	return kmixer_samplerate_check_params(&sp, &cp);
+}
+
+static int
+kmixer_chan_check_params(struct kmixer_ch *ch, const audio_params_t *p)
+{
+	return kmixer_check_params(kmixer_chan_hwparams(ch), p);
+}
+
+/*
+ * Round the requested low-water mark to whole frames within the ring,
+ * half the ring by default.
+ */
+static void
+kmixer_chan_set_lowat(struct kmixer_ch *ch)
+{
+	size_t fsize, lowat;
+
+	fsize = ch->ch_mixable ? kmixer_frame_size(&ch->ch_pparams) : 1;
+	lowat = ch->ch_lowatreq ? ch->ch_lowatreq : ch->ch_bufsize / 2;
+	lowat = MIN(lowat, ch->ch_bufsize);
+	lowat -= lowat % fsize;
+	ch->ch_lowat = MAX(lowat, fsize);
+}
+
+/*
+ * Bytes of ring for the depth the channel or hw.kmixer.bufsize asks
+ * for, in whole frames.
+ */
+static size_t
+kmixer_chan_ringsize(struct kmixer_ch *ch, size_t fsize)
+{
+	size_t size;
+
+	size = ch->ch_bufreq ? ch->ch_bufreq : ch->ch_softc->sc_bufsize;
+	if (size == 0 || size > KMIXER_BUFSIZE)
+		size = KMIXER_BUFSIZE;
+	size -= size % fsize;
+
+	return MAX(size, fsize);
+}
+
+/*
+ * Discard queued samples and restart conversion, after the channel's
+ * format or ring size changed.
+ */
+static void
+kmixer_chan_reset(struct kmixer_ch *ch)
+{
+	size_t fsize;
+	int i;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	/* callers keep the writer out, leaving keeps the mixers out */
+	kmixer_chan_leave(ch);
+
+	ch->ch_mixable = kmixer_chan_check_params(ch, &ch->ch_pparams) == 0;
+	fsize = ch->ch_mixable ? kmixer_frame_size(&ch->ch_pparams) : 1;
+
+	ch->ch_bufsize = kmixer_chan_ringsize(ch, fsize);
+	kmixer_chan_set_lowat(ch);
+	ch->ch_rhead = 0;
+	for (i = 0; i < KMIXER_MAXROUTES; i++)
+		ch->ch_rt[i].rt_head = 0;
+	ch->ch_rtail = 0;
+	/* a sample already mixed is still timed by its device */
+	(void)atomic_cas_uint(&ch->ch_latstate, KMIXER_LAT_ARMED,
+	    KMIXER_LAT_IDLE);
+
+	kmixer_chan_join(ch);
+}
+
+static void
+kmixer_route_leave(struct kmixer_route *rt)
+{
+	struct kmixer_pgroup *pg = rt->rt_pgroup;
+
+	KASSERT(mutex_owned(&rt->rt_hw->hw_lock));
+
+	if (pg == NULL)
+		return;
+	TAILQ_REMOVE(&pg->pg_rt, rt, rt_pgentry);
+	rt->rt_pgroup = NULL;
+	if (TAILQ_EMPTY(&pg->pg_rt)) {
+		TAILQ_REMOVE(&pg->pg_hw->hw_pgroups, pg, pg_entry);
+		kmixer_pgroup_free(pg);
+	}
+}
+
+/*
+ * Move a route to the group for its channel's play format on its device.
+ * Samples already queued are kept.
+ */
+static void
+kmixer_route_join(struct kmixer_route *rt)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+	struct kmixer_pgroup *pg;
+
+	KASSERT(mutex_owned(&rt->rt_hw->hw_lock));
+
+	kmixer_route_leave(rt);
+	if (!ch->ch_mixable)
+		return;
+	/* fails for formats this device cannot take, it plays silence */
+	pg = kmixer_pgroup_get(rt->rt_hw, &ch->ch_pparams, ch->ch_quality);
+	if (pg == NULL) {
+		rt->rt_silent = true;
+		return;
+	}
+	if (rt->rt_silent) {
+		/* the writer went on without it, see kmixer_chan_head() */
+		rt->rt_head = kmixer_chan_head(ch, ch->ch_rtail);
+		membar_producer();
+		rt->rt_silent = false;
+	}
+	TAILQ_INSERT_TAIL(&pg->pg_rt, rt, rt_pgentry);
+	rt->rt_pgroup = pg;
+	/* the channel may bring samples to a suspended device */
+	if (rt->rt_hw->hw_suspended)
+		cv_broadcast(&rt->rt_hw->hw_cv);
+}
+
+static void
+kmixer_chan_leave(struct kmixer_ch *ch)
+{
+	struct kmixer_route *rt;
+	int i;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		rt = &ch->ch_rt[i];
+		if (rt->rt_hw == NULL)
+			continue;
+		mutex_enter(&rt->rt_hw->hw_lock);
+		kmixer_route_leave(rt);
+		mutex_exit(&rt->rt_hw->hw_lock);
+	}
+}
+
+/*
+ * Move a channel to the groups for its play format on its devices.
+ * Samples already queued are kept.
+ */
+static void
+kmixer_chan_join(struct kmixer_ch *ch)
+{
+	struct kmixer_route *rt;
+	int i;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		rt = &ch->ch_rt[i];
+		if (rt->rt_hw == NULL)
+			continue;
+		mutex_enter(&rt->rt_hw->hw_lock);
+		kmixer_route_join(rt);
+		mutex_exit(&rt->rt_hw->hw_lock);
+	}
+}
+
+static const audio_params_t *
+kmixer_chan_hwrecparams(struct kmixer_ch *ch)
+{
+	struct kmixer_hw *hw = kmixer_chan_hw(ch);
+
+	return hw ? &hw->hw_rparams : &kmixer_hw_default;
+}
+
+/*
+ * Check that the capture path can produce a record format from a
+ * hardware format, see kmixer_capture_group().
+ */
+static int
+kmixer_check_recparams(const audio_params_t *hwp, const audio_params_t *p)
+{
+	audio_params_t cp;
+
+	if (p->sample_rate == 0 || p->channels == 0 ||
+	    p->channels > AUDIO_MAX_CHANNELS)
+		return EINVAL;
+	if (kmixer_mix_check_params(hwp) != 0)
+		return EINVAL;
+	if (kmixer_mix_check_params(p) != 0)
+		return EINVAL;
+
+	cp = *hwp;
+	cp.sample_rate = p->sample_rate;
+	cp.channels = p->channels;
+	return kmixer_samplerate_check_params(hwp, &cp);
+}
+
+static int
+kmixer_chan_check_recparams(struct kmixer_ch *ch, const audio_params_t *p)
+{
+	return kmixer_check_recparams(kmixer_chan_hwrecparams(ch), p);
+}
+
+static void
+kmixer_chan_rec_leave(struct kmixer_ch *ch)
+{
+	struct kmixer_rgroup *rg = ch->ch_recgroup;
+	struct kmixer_hw *hw;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	if (rg == NULL)
+		return;
+	hw = rg->rg_hw;
+	mutex_enter(&hw->hw_lock);
+	TAILQ_REMOVE(&rg->rg_ch, ch, ch_recentry);
+	ch->ch_recgroup = NULL;
+	if (TAILQ_EMPTY(&rg->rg_ch)) {
+		TAILQ_REMOVE(&hw->hw_rgroups, rg, rg_entry);
+		kmixer_rgroup_free(rg);
+	}
+	mutex_exit(&hw->hw_lock);
+}
+
+/*
+ * Move a recording channel to the group for its format on its current
+ * hardware, if any.  Samples already queued are kept.
+ */
+static void
+kmixer_chan_rec_join(struct kmixer_ch *ch)
+{
+	struct kmixer_rgroup *rg;
+	struct kmixer_hw *hw;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	kmixer_chan_rec_leave(ch);
+	hw = kmixer_chan_hw(ch);
+	if (!ch->ch_recok || hw == NULL)
+		return;
+	mutex_enter(&hw->hw_lock);
+	rg = kmixer_rgroup_get(hw, &ch->ch_recparams, ch->ch_quality);
+	if (rg != NULL) {
+		TAILQ_INSERT_TAIL(&rg->rg_ch, ch, ch_recentry);
+		ch->ch_recgroup = rg;
+	}
+	mutex_exit(&hw->hw_lock);
+}
+
+/*
+ * Start playing a channel on one more device, from the oldest sample
+ * still queued for the others so a moved channel loses nothing.  Does
+ * nothing if all the slots are taken.
+ */
+static void
+kmixer_route_add(struct kmixer_ch *ch, struct kmixer_hw *hw)
+{
+	struct kmixer_route *rt;
+	int i;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		if (ch->ch_rt[i].rt_hw == NULL)
+			break;
+	}
+	if (i == KMIXER_MAXROUTES)
+		return;
+	rt = &ch->ch_rt[i];
+
+	rt->rt_head = kmixer_chan_head(ch, ch->ch_rtail);
+	rt->rt_silent = false;
+	rt->rt_dry = true;
+	rt->rt_hw = hw;
+
+	/* the writer must count the route before its mixer can play it */
+	membar_producer();
+	ch->ch_rtmask |= __BIT(i);
+
+	mutex_enter(&hw->hw_lock);
+	kmixer_route_gain(rt, false);
+	TAILQ_INSERT_TAIL(&hw->hw_routes, rt, rt_entry);
+	kmixer_route_join(rt);
+	mutex_exit(&hw->hw_lock);
+}
+
+static void
+kmixer_route_del(struct kmixer_route *rt)
+{
+	struct kmixer_ch *ch = rt->rt_ch;
+	struct kmixer_hw *hw = rt->rt_hw;
+	u_int bit = __BIT(rt - ch->ch_rt);
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	mutex_enter(&hw->hw_lock);
+	kmixer_route_leave(rt);
+	kmixer_lat_clear(rt);
+	TAILQ_REMOVE(&hw->hw_routes, rt, rt_entry);
+	mutex_exit(&hw->hw_lock);
+
+	/* see kmixer_chan_head(); a silent route has played everything */
+	if (ch->ch_rtmask == bit) {
+		ch->ch_rhead = rt->rt_silent ? ch->ch_rtail : rt->rt_head;
+		membar_producer();
+	}
+	ch->ch_rtmask &= ~bit;
+	rt->rt_hw = NULL;
+}
+
+static void
+kmixer_chan_route_add(struct kmixer_ch *ch)
+{
+	struct kmixer_hw *hw;
+	int i;
+
+	TAILQ_FOREACH(hw, &ch->ch_softc->sc_hw, hw_entry) {
+		if (!hw->hw_open || !kmixer_chan_wants(ch, hw))
+			continue;
+		for (i = 0; i < KMIXER_MAXROUTES; i++) {
+			if (ch->ch_rt[i].rt_hw == hw)
+				break;
+		}
+		if (i == KMIXER_MAXROUTES)
+			kmixer_route_add(ch, hw);
+	}
+}
+
+/*
+ * Bring a channel's routes in line with the devices it wants, see
+ * KMIXER_SETROUTE.  Only open devices get a route; the migration thread
+ * opens the others first.
+ */
+static void
+kmixer_chan_route(struct kmixer_ch *ch)
+{
+	struct kmixer_hw *hw, *ohw;
+	int i;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	ohw = kmixer_chan_hw(ch);
+
+	/* add before removing, so the new routes start at the old heads */
+	kmixer_chan_route_add(ch);
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		hw = ch->ch_rt[i].rt_hw;
+		if (hw != NULL && !kmixer_chan_wants(ch, hw))
+			kmixer_route_del(&ch->ch_rt[i]);
+	}
+	/* unless the slots were all taken */
+	kmixer_chan_route_add(ch);
+
+	kmixer_chan_rehome(ch, ohw);
+}
+
+/*
+ * Recheck the channel's formats after the device in its first route
+ * changed, see kmixer_chan_hw().  Queued samples are kept, as the writer
+ * and reader may be running: a format the new device cannot take stops
+ * the channel until the next AUDIO_SETINFO.
+ */
+static void
+kmixer_chan_rehome(struct kmixer_ch *ch, struct kmixer_hw *ohw)
+{
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	if (kmixer_chan_hw(ch) != ohw)
+		kmixer_chan_recheck(ch);
+}
+
+/*
+ * Check the channel's formats against the device in its first route
+ * again, rejoining groups where that changes.  The record group is
+ * always rejoined.
+ */
+static void
+kmixer_chan_recheck(struct kmixer_ch *ch)
+{
+	bool ok;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	ok = kmixer_chan_check_params(ch, &ch->ch_pparams) == 0 &&
+	    ch->ch_bufsize % kmixer_frame_size(&ch->ch_pparams) == 0;
+	if (ok != ch->ch_mixable) {
+		ch->ch_mixable = ok;
+		kmixer_chan_join(ch);
+	}
+
+	if ((ch->ch_mode & AUMODE_RECORD) == 0)
+		return;
+	ch->ch_recok =
+	    kmixer_chan_check_recparams(ch, &ch->ch_recparams) == 0 &&
+	    ch->ch_recsize % kmixer_frame_size(&ch->ch_recparams) == 0;
+	kmixer_chan_rec_join(ch);
+}
+
+/* channels yet to set a format have no say in the device's */
+static inline bool
+kmixer_params_set(const audio_params_t *p)
+{
+	return memcmp(p, &kmixer_ch_default, sizeof(*p)) != 0;
+}
+
+/* 2 for each conversion of rate or channels spared, 1 for recoding */
+static int
+kmixer_params_score(const audio_params_t *hwp, const audio_params_t *p)
+{
+	int score = 0;
+
+	if (p->sample_rate == hwp->sample_rate &&
+	    p->channels == hwp->channels)
+		score += 2;
+	if (p->encoding == hwp->encoding && p->precision == hwp->precision)
+		score++;
+	return score;
+}
+
+/*
+ * Score a device format for the channels wanting the device, or -1 if
+ * one of their formats, or the ones a new channel starts with, could
+ * not be converted to or from it.
+ */
+static int
+kmixer_hw_score(struct kmixer_softc *sc, struct kmixer_hw *hw,
+    const audio_params_t *hwp)
+{
+	const audio_params_t *def = &kmixer_ch_default;
+	struct kmixer_ch *ch;
+	int score = 0;
+
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	if (kmixer_check_params(hwp, def) != 0 ||
+	    kmixer_check_recparams(hwp, def) != 0)
+		return -1;
+
+	TAILQ_FOREACH(ch, &sc->sc_ch, ch_entry) {
+		if (!kmixer_chan_wants(ch, hw))
+			continue;
+		if (ch->ch_mixable && kmixer_params_set(&ch->ch_pparams)) {
+			if (kmixer_check_params(hwp, &ch->ch_pparams) != 0)
+				return -1;
+			score += kmixer_params_score(hwp, &ch->ch_pparams);
+		}
+		if (ch->ch_recok && kmixer_params_set(&ch->ch_recparams)) {
+			if (kmixer_check_recparams(hwp, &ch->ch_recparams) != 0)
+				return -1;
+			score += kmixer_params_score(hwp, &ch->ch_recparams);
+		}
+	}
+	return score;
+}
+
+/*
+ * The rate hw.kmixer.rate has a device run at, or 0 to let the channels'
+ * formats decide, see kmixer_hw_choose().  Following the first channel
+ * keeps the device as it is until one has set a format.
+ */
+static u_int
+kmixer_hw_rate(struct kmixer_softc *sc, struct kmixer_hw *hw)
+{
+	struct kmixer_ch *ch;
+
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	switch (sc->sc_rate) {
+	case KMIXER_RATE_FIXED:
+		return KMIXER_SAMPLE_RATE;
+	case KMIXER_RATE_FIRST:
+		/* channels are kept in the order they were opened */
+		TAILQ_FOREACH(ch, &sc->sc_ch, ch_entry) {
+			if (!kmixer_chan_wants(ch, hw))
+				continue;
+			if (ch->ch_mixable && kmixer_params_set(&ch->ch_pparams))
+				return ch->ch_pparams.sample_rate;
+			if (ch->ch_recok && kmixer_params_set(&ch->ch_recparams))
+				return ch->ch_recparams.sample_rate;
+		}
+		return hw->hw_pparams.sample_rate;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Consider running a device at a channel's rate, unless the policy
+ * fixes it, and channels, and its encoding if the device takes that
+ * natively.
+ */
+static void
+kmixer_hw_consider(struct kmixer_softc *sc, struct kmixer_hw *hw,
+    const audio_params_t *cp, u_int rate, audio_params_t *best,
+    int *bestscore)
+{
+	audio_params_t p;
+	int score;
+
+	p = kmixer_hw_default;
+	p.sample_rate = rate ? rate : cp->sample_rate;
+	p.channels = cp->channels;
+	if (hw->hw_encs & kmixer_enc_bit(cp->encoding, cp->precision)) {
+		p.encoding = cp->encoding;
+		p.precision = p.validbits = cp->precision;
+	}
+	if (memcmp(&p, &hw->hw_badfmt, sizeof(p)) == 0)
+		return;
+
+	score = kmixer_hw_score(sc, hw, &p);
+	if (score > *bestscore) {
+		*best = p;
+		*bestscore = score;
+	}
+}
+
+/*
+ * Pick the format a device plays and records in: the one sparing the
+ * channels wanting it the most conversion, see kmixer_hw_score(), at
+ * the rate hw.kmixer.rate asks for if any.  Ties keep the current
+ * format, as changing it costs a glitch.
+ */
+static void
+kmixer_hw_choose(struct kmixer_softc *sc, struct kmixer_hw *hw,
+    audio_params_t *p)
+{
+	struct kmixer_ch *ch;
+	u_int rate;
+	int score;
+
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	rate = kmixer_hw_rate(sc, hw);
+	*p = hw->hw_pparams;
+	score = -1;
+	if (rate == 0 || rate == p->sample_rate)
+		score = kmixer_hw_score(sc, hw, p);
+	else
+		kmixer_hw_consider(sc, hw, p, rate, p, &score);
+	TAILQ_FOREACH(ch, &sc->sc_ch, ch_entry) {
+		if (!kmixer_chan_wants(ch, hw))
+			continue;
+		if (ch->ch_mixable)
+			kmixer_hw_consider(sc, hw, &ch->ch_pparams, rate, p,
+			    &score);
+		if (ch->ch_recok)
+			kmixer_hw_consider(sc, hw, &ch->ch_recparams, rate, p,
+			    &score);
+	}
+}
+
+/*
+ * Move an open device to the format its channels now suit best.  The
+ * switch is made at a block boundary: the mixer and capture threads
+ * are stopped as for kmixer_close_hw() and the driver plays out what
+ * it holds, leaving a gap but dropping nothing queued there.  Every
+ * group on the device is rebuilt, losing what the converters held; a
+ * format the driver refuses is not asked for again.
+ */
+static void
+kmixer_format_hw(struct kmixer_softc *sc, struct kmixer_hw *hw)
+{
+	struct kmixer_route *rt;
+	struct kmixer_ch *ch;
+	struct audio_info ai;
+	audio_params_t p, bad;
+	size_t blksize;
+	int err;
+
+	KASSERT(mutex_owned(&sc->sc_lock));
+
+	if (!hw->hw_open)
+		return;
+	kmixer_hw_choose(sc, hw, &p);
+	if (memcmp(&p, &hw->hw_pparams, sizeof(p)) == 0)
+		return;
+
+	mutex_enter(&hw->hw_lock);
+	hw->hw_open = false;
+	while (hw->hw_busy || hw->hw_rbusy)
+		cv_wait(&hw->hw_cv, &hw->hw_lock);
+	mutex_exit(&hw->hw_lock);
+
+	/*
+	 * The drain may take a whole driver queue, so other devices are
+	 * not held up on sc_lock meanwhile: as in kmixer_open_hw(),
+	 * hw_opening keeps openers and kmixer_del_hw() away, and routes
+	 * added meanwhile are regrouped below.
+	 */
+	hw->hw_opening = true;
+	mutex_exit(&sc->sc_lock);
+
+	memset(&bad, 0, sizeof(bad));
+	(void)cdev_ioctl(hw->hw_audiodev, AUDIO_DRAIN, NULL,
+	    FREAD|FWRITE, &lwp0);
+	err = kmixer_setformat_hw(hw, &p, &ai, &blksize);
+	if (err) {
+		printf("kmixer: %s: couldn't set format (%d)\n",
+		    kmixer_hw_devname(hw), err);
+		bad = p;
+		p = hw->hw_pparams;
+		err = kmixer_setformat_hw(hw, &p, &ai, &blksize);
+		if (err)
+			printf("kmixer: %s: couldn't restore format (%d)\n",
+			    kmixer_hw_devname(hw), err);
+	}
+
+	mutex_enter(&sc->sc_lock);
+	hw->hw_opening = false;
+	cv_broadcast(&sc->sc_cv);
+	if (bad.sample_rate != 0)
+		hw->hw_badfmt = bad;
+
+	/* groups are found by client format alone, so drop them all first */
+	TAILQ_FOREACH(rt, &hw->hw_routes, rt_entry) {
+		mutex_enter(&hw->hw_lock);
+		kmixer_route_leave(rt);
+		mutex_exit(&hw->hw_lock);
+		ch = rt->rt_ch;
+		if (ch->ch_recgroup != NULL && ch->ch_recgroup->rg_hw == hw)
+			kmixer_chan_rec_leave(ch);
+	}
+
+	mutex_enter(&hw->hw_lock);
+	hw->hw_pparams = hw->hw_rparams = p;
+	if (err == 0) {
+		hw->hw_blksize = blksize;
+		/* a new format gets the driver's block size afresh */
+		hw->hw_period = 0;
+		hw->hw_defblksize = ai.blocksize;
+		hw->hw_defhiwat = ai.hiwat;
+	}
+	memset(&hw->hw_pclock, 0, sizeof(hw->hw_pclock));
+	memset(&hw->hw_rclock, 0, sizeof(hw->hw_rclock));
+	mutex_exit(&hw->hw_lock);
+
+	TAILQ_FOREACH(rt, &hw->hw_routes, rt_entry) {
+		ch = rt->rt_ch;
+		if (kmixer_chan_hw(ch) == hw)
+			kmixer_chan_recheck(ch);
+		mutex_enter(&hw->hw_lock);
+		if (rt->rt_pgroup == NULL)
+			kmixer_route_join(rt);
+		mutex_exit(&hw->hw_lock);
+	}
+
+	mutex_enter(&hw->hw_lock);
+	hw->hw_open = true;
+	cv_broadcast(&hw->hw_cv);
+	mutex_exit(&hw->hw_lock);
+}
+
+/*
+ * Discard recorded samples and rejoin a group, after the channel's record
+ * format or ring size changed.
+ */
+static void
+kmixer_chan_rec_reset(struct kmixer_ch *ch)
+{
+	size_t fsize;
+
+	KASSERT(mutex_owned(&ch->ch_softc->sc_lock));
+
+	if ((ch->ch_mode & AUMODE_RECORD) == 0)
+		return;
+
+	/* callers keep the reader out, leaving keeps the capture out */
+	kmixer_chan_rec_leave(ch);
+
+	ch->ch_recok =
+	    kmixer_chan_check_recparams(ch, &ch->ch_recparams) == 0;
+	fsize = ch->ch_recok ? kmixer_frame_size(&ch->ch_recparams) : 1;
+
+	ch->ch_recsize = kmixer_chan_ringsize(ch, fsize);
+	ch->ch_rechead = 0;
+	ch->ch_rectail = 0;
+
+	kmixer_chan_rec_join(ch);
+}
+
+static int
+kmixer_chan_read(struct file *fp, off_t *offp, struct uio *uio,
+    kauth_cred_t cred, int flags)
+{
+	struct kmixer_ch *ch = fp->f_data;
+	size_t off, used, n, resid;
+	u_int head;
+	int err = 0;
+
+	if (uio->uio_resid == 0)
+		return 0;
+	resid = uio->uio_resid;
+
+	mutex_enter(&ch->ch_reclock);
+	if (!ch->ch_recok) {
+		mutex_exit(&ch->ch_reclock);
+		return EINVAL;
+	}
+	while (uio->uio_resid > 0) {
+		head = ch->ch_rechead;
+		used = kmixer_ring_used(ch->ch_recsize, head, ch->ch_rectail);
+		membar_consumer();
+
+		if (used == 0) {
+			if (fp->f_flag & FNONBLOCK) {
+				/* a partial read is not an error */
+				if (uio->uio_resid == resid)
+					err = EWOULDBLOCK;
+				break;
+			}
+
+			/* ring is empty, sleep until the next period */
+			mutex_enter(&ch->ch_lock);
+			ch->ch_recwait = true;
+			while (ch->ch_rectail == head) {
+				err = cv_wait_sig(&ch->ch_cv, &ch->ch_lock);
+				if (err)
+					break;
+			}
+			ch->ch_recwait = false;
+			mutex_exit(&ch->ch_lock);
+			if (err)
+				break;
+			continue;
+		}
+
+		/* only this reader touches the full part of the ring */
+		off = kmixer_ring_off(ch->ch_recsize, head);
+		n = MIN(used, ch->ch_recsize - off);
+		n = MIN(n, uio->uio_resid);
+		err = uiomove(ch->ch_recbuf + off, n, uio);
+		if (err)
+			break;
+
+		/* done reading before the capture may reuse the space */
+		membar_exit();
+		ch->ch_rechead = kmixer_ring_adv(ch->ch_recsize, head, n);
+	}
+	mutex_exit(&ch->ch_reclock);
+
+	return err;
+}
+
+/*
+ * Wake the mixers of the channel's devices that were suspended while
+ * nothing played, once the writer has queued samples.
+ */
+static void
+kmixer_chan_resume(struct kmixer_ch *ch)
+{
+	struct kmixer_softc *sc = ch->ch_softc;
+	struct kmixer_hw *hw;
+	int i;
+
+	KASSERT(mutex_owned(&ch->ch_wlock));
+
+	/* pairs with kmixer_hw_suspend() */
+	membar_sync();
+	if (sc->sc_nsuspended == 0)
+		return;
+
+	mutex_enter(&sc->sc_lock);
+	for (i = 0; i < KMIXER_MAXROUTES; i++) {
+		hw = ch->ch_rt[i].rt_hw;
+		if (hw == NULL)
+			continue;
+		mutex_enter(&hw->hw_lock);
+		if (hw->hw_suspended)
+			cv_broadcast(&hw->hw_cv);
+		mutex_exit(&hw->hw_lock);
+	}
+	mutex_exit(&sc->sc_lock);
+}
 
 static int
 kmixer_chan_write(struct file *fp, off_t *offp, struct uio *uio,
     kauth_cred_t cred, int flags)
 {
 	struct kmixer_ch *ch = fp->f_data;
-	//struct kmixer_softc *sc = ch->ch_softc;
+	size_t off, used, n, resid;
+	uint64_t stamp;
+	u_int tail;
+	int err = 0;
 
 	if (uio->uio_resid == 0)
 		return 0;
+	resid = uio->uio_resid;
 
-	mutex_enter(&ch->ch_lock);
+	mutex_enter(&ch->ch_wlock);
+	if (!ch->ch_mixable) {
+		mutex_exit(&ch->ch_wlock);
+		return EINVAL;
+	}
 	while (uio->uio_resid > 0) {
-		
+		tail = ch->ch_rtail;
+		used = kmixer_ring_used(ch->ch_bufsize,
+		    kmixer_chan_head(ch, tail), tail);
+		membar_consumer();
+
+		if (used == ch->ch_bufsize) {
+			if (fp->f_flag & FNONBLOCK) {
+				/* a partial write is not an error */
+				if (uio->uio_resid == resid)
+					err = EWOULDBLOCK;
+				break;
+			}
+
+			/* ring is full, sleep until the low-water mark */
+			ch->ch_wblocked++;
+			mutex_enter(&ch->ch_lock);
+			ch->ch_wwait = true;
+			while (kmixer_ring_free(ch) < ch->ch_lowat) {
+				err = cv_wait_sig(&ch->ch_cv, &ch->ch_lock);
+				if (err)
+					break;
+			}
+			ch->ch_wwait = false;
+			mutex_exit(&ch->ch_lock);
+			if (err)
+				break;
+			continue;
+		}
+
+		/* only this writer touches the free part of the ring */
+		off = kmixer_ring_off(ch->ch_bufsize, tail);
+		n = MIN(ch->ch_bufsize - used, ch->ch_bufsize - off);
+		n = MIN(n, uio->uio_resid);
+		err = uiomove(ch->ch_buf + off, n, uio);
+		if (err)
+			break;
+
+		stamp = kmixer_lat_stamp(ch);
+		/* samples are visible before the mixer sees the new tail */
+		membar_producer();
+		tail = kmixer_ring_adv(ch->ch_bufsize, tail, n);
+		ch->ch_rtail = tail;
+		kmixer_lat_arm(ch, tail, stamp);
+		SDT_PROBE3(kmixer, chan, write, enqueue, ch, tail, n);
+		kmixer_chan_resume(ch);
 	}
-	mutex_exit(&ch->ch_lock);
+	ch->ch_wframes += (resid - uio->uio_resid) /
+	    kmixer_frame_size(&ch->ch_pparams);
+	mutex_exit(&ch->ch_wlock);
+
+	return err;
+}
+
+static void
+kmixer_chan_getring(struct kmixer_ch *ch, struct kmixer_ring *kr)
+{
+	u_int head, tail;
+
+	tail = ch->ch_rtail;
+	head = kmixer_chan_head(ch, tail);
+	kr->size = ch->ch_bufsize;
+	kr->head = kmixer_ring_off(ch->ch_bufsize, head);
+	kr->tail = kmixer_ring_off(ch->ch_bufsize, tail);
+	kr->used = kmixer_ring_used(ch->ch_bufsize, head, tail);
+}
+
+/*
+ * Queue n bytes the client stored through its mapping of the ring, as
+ * kmixer_chan_write() does for data copied in.
+ */
+static int
+kmixer_chan_advance(struct kmixer_ch *ch, u_int n)
+{
+	uint64_t stamp;
+	u_int tail;
+	int err = 0;
+
+	mutex_enter(&ch->ch_wlock);
+	tail = ch->ch_rtail;
+	if (!ch->ch_mixable)
+		err = EINVAL;
+	else if (n % kmixer_frame_size(&ch->ch_pparams) != 0 ||
+	    n > ch->ch_bufsize - kmixer_ring_used(ch->ch_bufsize,
+	    kmixer_chan_head(ch, tail), tail))
+		err = EINVAL;
+	else {
+		stamp = kmixer_lat_stamp(ch);
+		membar_producer();
+		tail = kmixer_ring_adv(ch->ch_bufsize, tail, n);
+		ch->ch_rtail = tail;
+		kmixer_lat_arm(ch, tail, stamp);
+		SDT_PROBE3(kmixer, chan, write, enqueue, ch, tail, n);
+		ch->ch_wframes += n / kmixer_frame_size(&ch->ch_pparams);
+		kmixer_chan_resume(ch);
+	}
+	mutex_exit(&ch->ch_wlock);
+
+	return err;
+}
+
+static void
+kmixer_chan_getinfo(struct kmixer_ch *ch, struct audio_info *ai)
+{
+	const audio_params_t *p = &ch->ch_pparams;
+	const audio_params_t *rp = &ch->ch_recparams;
+	struct kmixer_hw *hw = kmixer_chan_hw(ch);
+
+	memset(ai, 0, sizeof(*ai));
+	ai->play.sample_rate = p->sample_rate;
+	ai->play.channels = p->channels;
+	ai->play.precision = p->precision;
+	ai->play.encoding = p->encoding;
+	ai->play.buffer_size = ch->ch_bufsize;
+	ai->play.open = (ch->ch_mode & AUMODE_PLAY) != 0;
+	ai->record.sample_rate = rp->sample_rate;
+	ai->record.channels = rp->channels;
+	ai->record.precision = rp->precision;
+	ai->record.encoding = rp->encoding;
+	ai->record.buffer_size = ch->ch_recsize;
+	ai->record.open = (ch->ch_mode & AUMODE_RECORD) != 0;
+	ai->mode = ch->ch_mode;
+	if (hw)
+		ai->blocksize = hw->hw_blksize;
+}
+
+static void
+kmixer_chan_prinfo(audio_params_t *p, const struct audio_prinfo *pi)
+{
+	if (pi->sample_rate != ~0u)
+		p->sample_rate = pi->sample_rate;
+	if (pi->channels != ~0u)
+		p->channels = pi->channels;
+	if (pi->precision != ~0u)
+		p->precision = p->validbits = pi->precision;
+	if (pi->encoding != ~0u)
+		p->encoding = pi->encoding;
+}
+
+static int
+kmixer_chan_setinfo(struct kmixer_ch *ch, const struct audio_info *ai)
+{
+	struct kmixer_softc *sc = ch->ch_softc;
+	audio_params_t p, rp;
+	int err;
+
+	/* keep readers and writers out while the rings are reset */
+	mutex_enter(&ch->ch_reclock);
+	mutex_enter(&ch->ch_wlock);
+	mutex_enter(&sc->sc_lock);
+	p = ch->ch_pparams;
+	kmixer_chan_prinfo(&p, &ai->play);
+	rp = ch->ch_recparams;
+	kmixer_chan_prinfo(&rp, &ai->record);
+	err = kmixer_chan_check_params(ch, &p);
+	if (err == 0 && (ch->ch_mode & AUMODE_RECORD))
+		err = kmixer_chan_check_recparams(ch, &rp);
+	if (err == 0 && memcmp(&p, &ch->ch_pparams, sizeof(p)) != 0) {
+		/* the mixers read ch_pparams */
+		kmixer_chan_leave(ch);
+		ch->ch_pparams = p;
+		kmixer_chan_reset(ch);
+	}
+	if (err == 0 && memcmp(&rp, &ch->ch_recparams, sizeof(rp)) != 0) {
+		ch->ch_recparams = rp;
+		kmixer_chan_rec_reset(ch);
+	}
+	/* the devices may suit the new formats better, see kmixer_hw_choose */
+	if (err == 0)
+		kmixer_migrate_kick(sc);
+	mutex_exit(&sc->sc_lock);
+	mutex_exit(&ch->ch_wlock);
+	mutex_exit(&ch->ch_reclock);
+
+	return err;
+}
+
+static void
+kmixer_chan_getlatency(struct kmixer_ch *ch, struct kmixer_latency *kl)
+{
+	struct kmixer_softc *sc = ch->ch_softc;
+	struct kmixer_hw *hw;
+
+	memset(kl, 0, sizeof(*kl));
+	mutex_enter(&sc->sc_lock);
+	hw = kmixer_chan_hw(ch);
+	if (hw != NULL) {
+		mutex_enter(&hw->hw_lock);
+		memcpy(kl->mix, hw->hw_mixhist, sizeof(kl->mix));
+		mutex_exit(&hw->hw_lock);
+	}
+	mutex_exit(&sc->sc_lock);
+	/* updated by whichever device mixed the timed sample */
+	memcpy(kl->lat, ch->ch_lathist, sizeof(kl->lat));
+}
+
+/*
+ * Set a channel's gain.  The mixers pick it up on their next period and
+ * ramp to it, see kmixer_route_gain().
+ */
+static int
+kmixer_chan_setgain(struct kmixer_ch *ch, const struct kmixer_gain *kg)
+{
+	int32_t l, r;
+
+	if (kg->gain > KMIXER_GAIN_MAX || kg->pan > KMIXER_PAN_MAX ||
+	    kg->pan < -KMIXER_PAN_MAX)
+		return EINVAL;
+
+	mutex_enter(&ch->ch_wlock);
+	ch->ch_gainreq = *kg;
+	l = r = kg->mute ? 0 : kg->gain;
+	/* pan attenuates the side it moves away from */
+	if (kg->pan > 0)
+		l = (int64_t)l * (KMIXER_PAN_MAX - kg->pan) / KMIXER_PAN_MAX;
+	else if (kg->pan < 0)
+		r = (int64_t)r * (KMIXER_PAN_MAX + kg->pan) / KMIXER_PAN_MAX;
+	ch->ch_gaingen++;
+	membar_producer();
+	ch->ch_gain[0] = l;
+	ch->ch_gain[1] = r;
+	ch->ch_gain[2] = kg->mute ? 0 : kg->gain;
+	membar_producer();
+	ch->ch_gaingen++;
+	mutex_exit(&ch->ch_wlock);
+
+	return 0;
+}
+
+static int
+kmixer_chan_setbufsize(struct kmixer_ch *ch, u_int size)
+{
+	struct kmixer_softc *sc = ch->ch_softc;
+
+	/* keep readers and writers out while the rings are reset */
+	mutex_enter(&ch->ch_reclock);
+	mutex_enter(&ch->ch_wlock);
+	mutex_enter(&sc->sc_lock);
+	ch->ch_bufreq = size;
+	kmixer_chan_reset(ch);
+	kmixer_chan_rec_reset(ch);
+	mutex_exit(&sc->sc_lock);
+	mutex_exit(&ch->ch_wlock);
+	mutex_exit(&ch->ch_reclock);
 
 	return 0;
 }
@@ -495,13 +3783,229 @@ kmixer_chan_write(struct file *fp, off_t *offp, struct uio *uio,
 static int
 kmixer_chan_ioctl(struct file *fp, u_long cmd, void *data)
 {
-	return ENXIO;	/* TODO */
+	struct kmixer_ch *ch = fp->f_data;
+	struct kmixer_softc *sc = ch->ch_softc;
+	struct kmixer_hw *hw;
+	u_int route, period;
+	int q;
+
+	switch (cmd) {
+	case AUDIO_GETINFO:
+		mutex_enter(&sc->sc_lock);
+		kmixer_chan_getinfo(ch, data);
+		mutex_exit(&sc->sc_lock);
+		return 0;
+	case AUDIO_SETINFO:
+		return kmixer_chan_setinfo(ch, data);
+	case KMIXER_GETQUALITY:
+		*(int *)data = ch->ch_quality;
+		return 0;
+	case KMIXER_SETQUALITY:
+		q = *(int *)data;
+		if (q != KMIXER_QUALITY_LINEAR && q != KMIXER_QUALITY_SHORT &&
+		    q != KMIXER_QUALITY_LONG)
+			return EINVAL;
+		mutex_enter(&sc->sc_lock);
+		if (q != ch->ch_quality) {
+			ch->ch_quality = q;
+			kmixer_chan_join(ch);
+			kmixer_chan_rec_join(ch);
+		}
+		mutex_exit(&sc->sc_lock);
+		return 0;
+	case KMIXER_GETRING:
+		mutex_enter(&ch->ch_wlock);
+		kmixer_chan_getring(ch, data);
+		mutex_exit(&ch->ch_wlock);
+		return 0;
+	case KMIXER_ADVANCE:
+		return kmixer_chan_advance(ch, *(u_int *)data);
+	case KMIXER_GETLOWAT:
+		*(u_int *)data = ch->ch_lowat;
+		return 0;
+	case KMIXER_SETLOWAT:
+		mutex_enter(&ch->ch_wlock);
+		ch->ch_lowatreq = *(u_int *)data;
+		kmixer_chan_set_lowat(ch);
+		mutex_exit(&ch->ch_wlock);
+		return 0;
+	case KMIXER_GETROUTE:
+		*(u_int *)data = ch->ch_route;
+		return 0;
+	case KMIXER_SETROUTE:
+		route = *(u_int *)data;
+		if (popcount32(route) > KMIXER_MAXROUTES)
+			return EINVAL;
+		mutex_enter(&sc->sc_lock);
+		ch->ch_route = route;
+		kmixer_chan_route(ch);
+		/* to open devices not in use yet and close the others */
+		kmixer_migrate_kick(sc);
+		mutex_exit(&sc->sc_lock);
+		return 0;
+	case KMIXER_GETPERIOD:
+		mutex_enter(&sc->sc_lock);
+		hw = kmixer_chan_hw(ch);
+		*(u_int *)data = hw ? kmixer_hw_period(hw) : 0;
+		mutex_exit(&sc->sc_lock);
+		return 0;
+	case KMIXER_SETPERIOD:
+		period = *(u_int *)data;
+		mutex_enter(&sc->sc_lock);
+		ch->ch_periodreq = period ? MAX(period, KMIXER_MINPERIOD) : 0;
+		kmixer_migrate_kick(sc);
+		mutex_exit(&sc->sc_lock);
+		return 0;
+	case KMIXER_GETBUFSIZE:
+		*(u_int *)data = ch->ch_bufsize;
+		return 0;
+	case KMIXER_SETBUFSIZE:
+		return kmixer_chan_setbufsize(ch, *(u_int *)data);
+	case KMIXER_GETLATENCY:
+		kmixer_chan_getlatency(ch, data);
+		return 0;
+	case KMIXER_GETGAIN:
+		mutex_enter(&ch->ch_wlock);
+		*(struct kmixer_gain *)data = ch->ch_gainreq;
+		mutex_exit(&ch->ch_wlock);
+		return 0;
+	case KMIXER_SETGAIN:
+		return kmixer_chan_setgain(ch, data);
+	case FIONBIO:
+		/* FNONBLOCK in f_flag is checked by kmixer_chan_write */
+		return 0;
+	default:
+		return ENXIO;	/* TODO */
+	}
 }
 
 static int
 kmixer_chan_poll(struct file *fp, int events)
 {
-	return 0;	/* TODO */
+	struct kmixer_ch *ch = fp->f_data;
+	int revents = 0;
+
+	mutex_enter(&ch->ch_lock);
+	if ((events & (POLLOUT | POLLWRNORM)) &&
+	    (ch->ch_mode & AUMODE_PLAY)) {
+		if (kmixer_ring_free(ch) >= ch->ch_lowat) {
+			revents |= events & (POLLOUT | POLLWRNORM);
+		} else {
+			/* kmixer_chan_wake() notifies once the mark is free */
+			ch->ch_pwait = true;
+			selrecord(curlwp, &ch->ch_wsel);
+		}
+	}
+	if ((events & (POLLIN | POLLRDNORM)) &&
+	    (ch->ch_mode & AUMODE_RECORD)) {
+		if (ch->ch_rechead != ch->ch_rectail) {
+			revents |= events & (POLLIN | POLLRDNORM);
+		} else {
+			/* kmixer_capture_chan() notifies the next period */
+			ch->ch_recpwait = true;
+			selrecord(curlwp, &ch->ch_recsel);
+		}
+	}
+	mutex_exit(&ch->ch_lock);
+
+	return revents;
+}
+
+static void
+kmixer_chan_kqdetach(struct knote *kn)
+{
+	struct kmixer_ch *ch = kn->kn_hook;
+
+	mutex_enter(&ch->ch_lock);
+	SLIST_REMOVE(&ch->ch_wsel.sel_klist, kn, knote, kn_selnext);
+	ch->ch_nknotes--;
+	mutex_exit(&ch->ch_lock);
+}
+
+static int
+kmixer_chan_kqwrite(struct knote *kn, long hint)
+{
+	struct kmixer_ch *ch = kn->kn_hook;
+	int rv;
+
+	if (hint != NOTE_SUBMIT)
+		mutex_enter(&ch->ch_lock);
+	kn->kn_data = kmixer_ring_free(ch);
+	rv = kn->kn_data >= ch->ch_lowat;
+	if (hint != NOTE_SUBMIT)
+		mutex_exit(&ch->ch_lock);
+
+	return rv;
+}
+
+static const struct filterops kmixer_write_filtops = {
+	.f_isfd = 1,
+	.f_attach = NULL,
+	.f_detach = kmixer_chan_kqdetach,
+	.f_event = kmixer_chan_kqwrite,
+};
+
+static void
+kmixer_chan_kqrdetach(struct knote *kn)
+{
+	struct kmixer_ch *ch = kn->kn_hook;
+
+	mutex_enter(&ch->ch_lock);
+	SLIST_REMOVE(&ch->ch_recsel.sel_klist, kn, knote, kn_selnext);
+	ch->ch_recnknotes--;
+	mutex_exit(&ch->ch_lock);
+}
+
+static int
+kmixer_chan_kqread(struct knote *kn, long hint)
+{
+	struct kmixer_ch *ch = kn->kn_hook;
+
+	if (hint != NOTE_SUBMIT)
+		mutex_enter(&ch->ch_lock);
+	kn->kn_data = kmixer_ring_used(ch->ch_recsize, ch->ch_rechead,
+	    ch->ch_rectail);
+	if (hint != NOTE_SUBMIT)
+		mutex_exit(&ch->ch_lock);
+
+	return kn->kn_data > 0;
+}
+
+static const struct filterops kmixer_read_filtops = {
+	.f_isfd = 1,
+	.f_attach = NULL,
+	.f_detach = kmixer_chan_kqrdetach,
+	.f_event = kmixer_chan_kqread,
+};
+
+static int
+kmixer_chan_kqfilter(struct file *fp, struct knote *kn)
+{
+	struct kmixer_ch *ch = fp->f_data;
+
+	kn->kn_hook = ch;
+	switch (kn->kn_filter) {
+	case EVFILT_WRITE:
+		if ((ch->ch_mode & AUMODE_PLAY) == 0)
+			return EINVAL;
+		kn->kn_fop = &kmixer_write_filtops;
+		mutex_enter(&ch->ch_lock);
+		SLIST_INSERT_HEAD(&ch->ch_wsel.sel_klist, kn, kn_selnext);
+		ch->ch_nknotes++;
+		mutex_exit(&ch->ch_lock);
+		return 0;
+	case EVFILT_READ:
+		if ((ch->ch_mode & AUMODE_RECORD) == 0)
+			return EINVAL;
+		kn->kn_fop = &kmixer_read_filtops;
+		mutex_enter(&ch->ch_lock);
+		SLIST_INSERT_HEAD(&ch->ch_recsel.sel_klist, kn, kn_selnext);
+		ch->ch_recnknotes++;
+		mutex_exit(&ch->ch_lock);
+		return 0;
+	default:
+		return EINVAL;
+	}
 }
 
 static int
@@ -514,6 +4018,42 @@ kmixer_chan_close(struct file *fp)
 	return 0;
 }
 
+/*
+ * Map the channel ring, so the client stores samples where the mixer
+ * reads them.  See struct kmixer_ring.
+ */
+static int
+kmixer_chan_mmap(struct file *fp, off_t *offp, size_t len, int prot,
+    int *flagsp, int *advicep, struct uvm_object **uobjp, int *maxprotp)
+{
+	struct kmixer_ch *ch = fp->f_data;
+	int maxprot;
+
+	if (*offp < 0 || *offp >= KMIXER_BUFMAPSIZE ||
+	    len > KMIXER_BUFMAPSIZE - *offp)
+		return EINVAL;
+
+	/* only a descriptor open for writing may store into the ring */
+	maxprot = VM_PROT_READ;
+	if (fp->f_flag & FWRITE)
+		maxprot |= VM_PROT_WRITE;
+	if ((prot & maxprot) != prot)
+		return EACCES;
+
+	/* kmixer_alloc_chan() scrubbed what an earlier open left */
+	mutex_enter(&ch->ch_wlock);
+	ch->ch_mapped = true;
+	mutex_exit(&ch->ch_wlock);
+
+	uao_reference(ch->ch_uobj);
+	*uobjp = ch->ch_uobj;
+	*maxprotp = maxprot;
+	*advicep = UVM_ADV_RANDOM;
+	*flagsp = MAP_SHARED;
+
+	return 0;
+}
+
 MODULE(MODULE_CLASS_DRIVER, kmixer, NULL);
 
 static int
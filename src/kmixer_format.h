@@ -0,0 +1,71 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _KMIXER_FORMAT_H
+#define _KMIXER_FORMAT_H
+
+#include <sys/bitops.h>
+
+/*
+ * Float samples are converted to and from 32-bit integers (full scale
+ * 2^31) by taking the IEEE 754 bits apart, so the kernel never needs the
+ * FPU.  Out of range values, infinities and NaNs saturate, and both
+ * directions truncate towards zero.
+ */
+static inline int32_t
+kmixer_float_to_s32(uint32_t f)
+{
+	const int shift = (int)((f >> 23) & 0xff) - 119;
+	const uint32_t m = (f & 0x7fffff) | 0x800000;
+	int32_t v;
+
+	/* |f| = m * 2^(e - 150), so f * 2^31 = m << (e - 119) */
+	if (shift >= 8)
+		return (f & 0x80000000) ? INT32_MIN : INT32_MAX;
+	if (shift <= -24)
+		return 0;
+	v = shift >= 0 ? (int32_t)(m << shift) : (int32_t)(m >> -shift);
+	return (f & 0x80000000) ? -v : v;
+}
+
+static inline uint32_t
+kmixer_s32_to_float(int32_t v)
+{
+	uint32_t sign, m;
+	int msb;
+
+	if (v == 0)
+		return 0;
+	sign = v < 0 ? 0x80000000 : 0;
+	m = v < 0 ? -(uint32_t)v : (uint32_t)v;
+	msb = fls32(m) - 1;
+	m = msb > 23 ? m >> (msb - 23) : m << (23 - msb);
+	return sign | (uint32_t)(msb + 96) << 23 | (m & 0x7fffff);
+}
+
+#endif /* !_KMIXER_FORMAT_H */
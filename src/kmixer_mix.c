@@ -0,0 +1,571 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/cdefs.h>
+__KERNEL_RCSID(0, "$NetBSD$");
+
+#include <sys/types.h>
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/bitops.h>
+#include <sys/endian.h>
+#include <sys/errno.h>
+#include <sys/audioio.h>
+
+#include <dev/audio_if.h>
+
+#include "kmixer_format.h"
+#include "kmixer_mix.h"
+#include "kmixer_mix_tables.h"
+#include "kmixer_simd.h"
+#include "kmixerio.h"
+
+static inline int32_t
+kmixer_mix_sat(int64_t v)
+{
+	if (v > INT32_MAX)
+		return INT32_MAX;
+	if (v < INT32_MIN)
+		return INT32_MIN;
+	return (int32_t)v;
+}
+
+static inline int32_t
+kmixer_mix_clip(int32_t v)
+{
+	if (v > KMIXER_BUS_MAX)
+		return KMIXER_BUS_MAX;
+	if (v < KMIXER_BUS_MIN)
+		return KMIXER_BUS_MIN;
+	return v;
+}
+
+/*
+ * 32-bit samples, integer or float, at full 32-bit scale.
+ */
+static inline int32_t
+kmixer_mix_dec32(const uint8_t *src, u_int encoding)
+{
+	switch (encoding) {
+	case AUDIO_ENCODING_SLINEAR_LE:
+		return (int32_t)le32dec(src);
+	case AUDIO_ENCODING_SLINEAR_BE:
+		return (int32_t)be32dec(src);
+	case KMIXER_ENCODING_FLOAT_LE:
+		return kmixer_float_to_s32(le32dec(src));
+	default:
+		return kmixer_float_to_s32(be32dec(src));
+	}
+}
+
+static inline void
+kmixer_mix_enc32(uint8_t *dst, int32_t v, u_int encoding)
+{
+	switch (encoding) {
+	case AUDIO_ENCODING_SLINEAR_LE:
+		le32enc(dst, (uint32_t)v);
+		break;
+	case AUDIO_ENCODING_SLINEAR_BE:
+		be32enc(dst, (uint32_t)v);
+		break;
+	case KMIXER_ENCODING_FLOAT_LE:
+		le32enc(dst, kmixer_s32_to_float(v));
+		break;
+	default:
+		be32enc(dst, kmixer_s32_to_float(v));
+		break;
+	}
+}
+
+/*
+ * The 8-bit encodings decode through a table to 16-bit linear.
+ */
+static const int16_t *
+kmixer_mix_table8(u_int encoding)
+{
+	switch (encoding) {
+	case AUDIO_ENCODING_ULAW:
+		return kmixer_ulaw_table;
+	case AUDIO_ENCODING_ALAW:
+		return kmixer_alaw_table;
+	case AUDIO_ENCODING_SLINEAR_LE:
+	case AUDIO_ENCODING_SLINEAR_BE:
+		return kmixer_slinear8_table;
+	default:
+		return kmixer_ulinear8_table;
+	}
+}
+
+/*
+ * ITU-T G.711 encoders from 16-bit linear, the inverse of
+ * kmixer_ulaw_table and kmixer_alaw_table.
+ */
+static inline uint8_t
+kmixer_mix_enc_ulaw(int32_t v)
+{
+	uint8_t mask;
+	int seg;
+
+	v >>= 2;
+	if (v < 0) {
+		v = -v;
+		mask = 0x7f;
+	} else {
+		mask = 0xff;
+	}
+	v = MIN(v, 8159) + 0x21;
+	seg = fls32(v >> 6);
+	return ((seg << 4) | ((v >> (seg + 1)) & 0x0f)) ^ mask;
+}
+
+static inline uint8_t
+kmixer_mix_enc_alaw(int32_t v)
+{
+	uint8_t mask;
+	int seg;
+
+	v >>= 3;
+	if (v >= 0) {
+		mask = 0xd5;
+	} else {
+		v = -v - 1;
+		mask = 0x55;
+	}
+	seg = fls32(v >> 5);
+	if (seg >= 8)
+		return 0x7f ^ mask;
+	return ((seg << 4) | ((v >> (seg < 2 ? 1 : seg)) & 0x0f)) ^ mask;
+}
+
+static inline uint8_t
+kmixer_mix_enc8(int32_t v, u_int encoding)
+{
+	switch (encoding) {
+	case AUDIO_ENCODING_ULAW:
+		return kmixer_mix_enc_ulaw(v);
+	case AUDIO_ENCODING_ALAW:
+		return kmixer_mix_enc_alaw(v);
+	case AUDIO_ENCODING_SLINEAR_LE:
+	case AUDIO_ENCODING_SLINEAR_BE:
+		return (uint8_t)(v >> 8);
+	default:
+		return (uint8_t)((v >> 8) ^ 0x80);
+	}
+}
+
+/*
+ * Formats the mix bus can be fed from and written out to.
+ */
+int
+kmixer_mix_check_params(const struct audio_params *p)
+{
+	switch (p->encoding) {
+	case AUDIO_ENCODING_SLINEAR_LE:
+	case AUDIO_ENCODING_SLINEAR_BE:
+		if (p->precision != 8 && p->precision != 16 &&
+		    p->precision != 24 && p->precision != 32)
+			return EINVAL;
+		return 0;
+	case AUDIO_ENCODING_ULINEAR_LE:
+	case AUDIO_ENCODING_ULINEAR_BE:
+	case AUDIO_ENCODING_ULAW:
+	case AUDIO_ENCODING_ALAW:
+		if (p->precision != 8)
+			return EINVAL;
+		return 0;
+	case KMIXER_ENCODING_FLOAT_LE:
+	case KMIXER_ENCODING_FLOAT_BE:
+		if (p->precision != 32)
+			return EINVAL;
+		return 0;
+	default:
+		return EINVAL;
+	}
+}
+
+/*
+ * Accumulate nsamples samples in format p from src into the mix bus.
+ */
+void
+kmixer_mix_add(int32_t *bus, const uint8_t *src,
+    const struct audio_params *p, u_int nsamples)
+{
+	const int shift = KMIXER_BUS_BITS - p->precision;
+	const int16_t *tab;
+	int32_t v;
+	u_int i;
+
+	if (p->precision == 16 && p->encoding == AUDIO_ENCODING_SLINEAR_NE &&
+	    ((uintptr_t)src & 1) == 0) {
+		kmixer_simd_mix_add_s16(bus, (const int16_t *)src, nsamples);
+		return;
+	}
+
+	switch (p->precision) {
+	case 8:
+		/* decode and accumulate in one pass */
+		tab = kmixer_mix_table8(p->encoding);
+		for (i = 0; i < nsamples; i++) {
+			v = tab[src[i]] << (KMIXER_BUS_BITS - 16);
+			bus[i] = kmixer_mix_sat((int64_t)bus[i] + v);
+		}
+		break;
+	case 16:
+		/* a byte swap is cheaper than a 64k entry table */
+		if (p->encoding == AUDIO_ENCODING_SLINEAR_LE) {
+			for (i = 0; i < nsamples; i++, src += 2) {
+				v = (int16_t)le16dec(src);
+				bus[i] = kmixer_mix_sat((int64_t)bus[i] +
+				    (v << shift));
+			}
+		} else {
+			for (i = 0; i < nsamples; i++, src += 2) {
+				v = (int16_t)be16dec(src);
+				bus[i] = kmixer_mix_sat((int64_t)bus[i] +
+				    (v << shift));
+			}
+		}
+		break;
+	case 24:
+		for (i = 0; i < nsamples; i++, src += 3) {
+			if (p->encoding == AUDIO_ENCODING_SLINEAR_LE)
+				v = src[0] | (src[1] << 8) |
+				    ((int8_t)src[2] << 16);
+			else
+				v = src[2] | (src[1] << 8) |
+				    ((int8_t)src[0] << 16);
+			bus[i] = kmixer_mix_sat((int64_t)bus[i] + v);
+		}
+		break;
+	case 32:
+		/* the bus keeps the top KMIXER_BUS_BITS */
+		for (i = 0; i < nsamples; i++, src += 4) {
+			v = kmixer_mix_dec32(src, p->encoding) >>
+			    (32 - KMIXER_BUS_BITS);
+			bus[i] = kmixer_mix_sat((int64_t)bus[i] + v);
+		}
+		break;
+	}
+}
+
+/*
+ * Aim a gain at new targets, reached after nframes frames.
+ */
+void
+kmixer_mix_ramp(struct kmixer_ramp *r, const int32_t *target, u_int nframes)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		r->r_target[i] = target[i];
+		if (nframes == 0)
+			r->r_gain[i] = target[i];
+		else
+			r->r_step[i] =
+			    (target[i] - r->r_gain[i]) / (int32_t)nframes;
+	}
+	r->r_frames = nframes;
+}
+
+/*
+ * Decode, scale and accumulate frames as kmixer_mix_add() does.  The
+ * gain moves one step before each frame of a ramp and lands on the
+ * target exactly with its last one.
+ */
+#define KMIXER_MIX_GAIN(ssize, dec)					\
+	for (f = 0; f < nframes; f++) {					\
+		if (frames > 0) {					\
+			if (--frames == 0) {				\
+				g0 = r->r_target[0];			\
+				g1 = r->r_target[1];			\
+			} else {					\
+				g0 += r->r_step[0];			\
+				g1 += r->r_step[1];			\
+			}						\
+		}							\
+		for (c = 0; c < nch; c++, src += (ssize), bus++) {	\
+			v = (dec);					\
+			v = ((int64_t)v * (c == 1 && nch == 2 ? g1 : g0)) >> \
+			    KMIXER_MIX_GAINBITS;			\
+			*bus = kmixer_mix_sat((int64_t)*bus + v);	\
+		}							\
+	}
+
+/*
+ * Accumulate nframes frames in format p from src into the mix bus,
+ * scaled by a gain in the same pass.  A steady gain of unity takes the
+ * kmixer_mix_add() kernels, a steady zero adds nothing.
+ */
+void
+kmixer_mix_add_gain(int32_t *bus, const uint8_t *src,
+    const struct audio_params *p, u_int nframes, struct kmixer_ramp *r)
+{
+	const int shift = KMIXER_BUS_BITS - p->precision;
+	const u_int nch = p->channels;
+	const int16_t *tab;
+	int32_t g0, g1, v;
+	u_int frames, f, c;
+
+	if (r->r_frames == 0 && r->r_gain[0] == r->r_gain[1]) {
+		if (r->r_gain[0] == KMIXER_MIX_UNITY) {
+			kmixer_mix_add(bus, src, p, nframes * nch);
+			return;
+		}
+		if (r->r_gain[0] == 0)
+			return;
+	}
+
+	g0 = r->r_gain[0];
+	g1 = r->r_gain[1];
+	frames = r->r_frames;
+
+	switch (p->precision) {
+	case 8:
+		tab = kmixer_mix_table8(p->encoding);
+		KMIXER_MIX_GAIN(1, tab[*src] << (KMIXER_BUS_BITS - 16));
+		break;
+	case 16:
+		if (p->encoding == AUDIO_ENCODING_SLINEAR_LE) {
+			KMIXER_MIX_GAIN(2, (int16_t)le16dec(src) << shift);
+		} else {
+			KMIXER_MIX_GAIN(2, (int16_t)be16dec(src) << shift);
+		}
+		break;
+	case 24:
+		if (p->encoding == AUDIO_ENCODING_SLINEAR_LE) {
+			KMIXER_MIX_GAIN(3, src[0] | (src[1] << 8) |
+			    ((int8_t)src[2] << 16));
+		} else {
+			KMIXER_MIX_GAIN(3, src[2] | (src[1] << 8) |
+			    ((int8_t)src[0] << 16));
+		}
+		break;
+	case 32:
+		KMIXER_MIX_GAIN(4, kmixer_mix_dec32(src, p->encoding) >>
+		    (32 - KMIXER_BUS_BITS));
+		break;
+	}
+
+	r->r_gain[0] = g0;
+	r->r_gain[1] = g1;
+	r->r_frames = frames;
+}
+
+#undef KMIXER_MIX_GAIN
+
+/*
+ * Clip nsamples samples of the mix bus and store them in format p at dst.
+ */
+void
+kmixer_mix_out(uint8_t *dst, const int32_t *bus,
+    const struct audio_params *p, u_int nsamples)
+{
+	const int shift = KMIXER_BUS_BITS - p->precision;
+	int32_t v;
+	u_int i;
+
+	if (p->precision == 16 && p->encoding == AUDIO_ENCODING_SLINEAR_NE &&
+	    ((uintptr_t)dst & 1) == 0) {
+		kmixer_simd_mix_out_s16((int16_t *)dst, bus, nsamples);
+		return;
+	}
+
+	switch (p->precision) {
+	case 8:
+		for (i = 0; i < nsamples; i++) {
+			v = kmixer_mix_clip(bus[i]) >> (KMIXER_BUS_BITS - 16);
+			dst[i] = kmixer_mix_enc8(v, p->encoding);
+		}
+		break;
+	case 16:
+		for (i = 0; i < nsamples; i++, dst += 2) {
+			v = kmixer_mix_clip(bus[i]) >> shift;
+			if (p->encoding == AUDIO_ENCODING_SLINEAR_LE)
+				le16enc(dst, (uint16_t)v);
+			else
+				be16enc(dst, (uint16_t)v);
+		}
+		break;
+	case 24:
+		for (i = 0; i < nsamples; i++, dst += 3) {
+			v = kmixer_mix_clip(bus[i]);
+			if (p->encoding == AUDIO_ENCODING_SLINEAR_LE) {
+				dst[0] = v;
+				dst[1] = v >> 8;
+				dst[2] = v >> 16;
+			} else {
+				dst[0] = v >> 16;
+				dst[1] = v >> 8;
+				dst[2] = v;
+			}
+		}
+		break;
+	case 32:
+		for (i = 0; i < nsamples; i++, dst += 4) {
+			v = (int32_t)((uint32_t)kmixer_mix_clip(bus[i]) <<
+			    (32 - KMIXER_BUS_BITS));
+			kmixer_mix_enc32(dst, v, p->encoding);
+		}
+		break;
+	}
+}
+
+/*
+ * Seed the generators of a dither state from any value.
+ */
+void
+kmixer_mix_dither_init(struct kmixer_dither *d, uint32_t seed)
+{
+	u_int l;
+
+	memset(d, 0, sizeof(*d));
+	for (l = 0; l < KMIXER_DITHER_LANES; l++) {
+		seed = seed * 1664525 + 1013904223;
+		d->d_seed[l] = seed | 1;
+	}
+}
+
+static inline uint32_t
+kmixer_mix_xorshift(uint32_t *x)
+{
+	*x ^= *x << 13;
+	*x ^= *x >> 17;
+	*x ^= *x << 5;
+	return *x;
+}
+
+/* one sample rounded to a multiple of lsb with TPDF noise from x */
+static inline int32_t
+kmixer_mix_tpdf(int32_t v, uint32_t *x, int32_t lsb)
+{
+	return (v + lsb / 2 + kmixer_tpdf_table[kmixer_mix_xorshift(x) >>
+	    (32 - KMIXER_TPDF_BITS)] * (lsb >> 8)) & ~(lsb - 1);
+}
+
+/*
+ * TPDF dither without feedback to other than 16 bits, which
+ * kmixer_simd_dither_s16() rounds the same way.  Each sample takes the
+ * next generator in turn, so nothing carries from one to the next.
+ */
+static void
+kmixer_mix_dither_tpdf(int32_t *bus, u_int nsamples, int32_t lsb,
+    uint32_t *seed)
+{
+	uint32_t x[KMIXER_DITHER_LANES];
+	u_int i;
+
+	/* a local copy, as stores to the bus could alias the seeds */
+	memcpy(x, seed, sizeof(x));
+	for (i = 0; i < nsamples; i++) {
+		bus[i] = kmixer_mix_tpdf(kmixer_mix_clip(bus[i]),
+		    &x[i % KMIXER_DITHER_LANES], lsb);
+	}
+	memcpy(seed, x, sizeof(x));
+}
+
+/*
+ * Dither nsamples samples of the mix bus in place for kmixer_mix_out()
+ * to store in format p, which truncates.  Each sample gets TPDF noise
+ * of up to an output LSB either way from kmixer_tpdf_table, indexed by
+ * xorshift generators, and half an LSB to round.  With d_shape the
+ * error left by each sample is taken off the next on its channel,
+ * pushing the noise up towards Nyquist; clipping near full scale would
+ * let the error grow, so it is held to what rounding alone can leave.
+ * That feedback is serial and stays scalar; plain TPDF carries nothing
+ * from one sample to the next and runs in the vector kernels for 16-bit
+ * output.  Only linear formats narrower than the bus are dithered, and
+ * a block already exact at their precision, such as silence or 16-bit
+ * channels mixed at unity gain without resampling, is left as it is.
+ */
+void
+kmixer_mix_dither(int32_t *bus, const struct audio_params *p,
+    u_int nsamples, struct kmixer_dither *d)
+{
+	const int shift = KMIXER_BUS_BITS - p->precision;
+	const int32_t lsb = 1 << shift;
+	/* the most a sample left unclipped can be off by */
+	const int32_t lim = lsb + lsb / 2;
+	const u_int nch = p->channels;
+	const bool shape = d->d_shape;
+	int32_t err[AUDIO_MAX_CHANNELS];
+	uint32_t x, exact = 0;
+	int32_t v, q;
+	u_int i, c;
+
+	if (p->precision >= KMIXER_BUS_BITS ||
+	    p->encoding == AUDIO_ENCODING_ULAW ||
+	    p->encoding == AUDIO_ENCODING_ALAW)
+		return;
+	KASSERT(shift >= 8);
+	KASSERT(nch <= AUDIO_MAX_CHANNELS);
+
+	for (i = 0; i < nsamples; i++)
+		exact |= bus[i];
+	if ((exact & (lsb - 1)) == 0) {
+		memset(d->d_err, 0, sizeof(d->d_err));
+		return;
+	}
+
+	if (!shape) {
+		memset(d->d_err, 0, sizeof(d->d_err));
+		if (shift == KMIXER_SIMD_SHIFT16)
+			kmixer_simd_dither_s16(bus, nsamples, d->d_seed);
+		else
+			kmixer_mix_dither_tpdf(bus, nsamples, lsb, d->d_seed);
+		return;
+	}
+
+	/* the error feedback is serial, one generator will do */
+	x = d->d_seed[0];
+	/* a local copy, as stores to the bus could alias d_err */
+	memcpy(err, d->d_err, sizeof(err));
+	for (i = c = 0; i < nsamples; i++) {
+		v = kmixer_mix_clip(bus[i]) - err[c];
+		/* the error fed back is that of what is actually stored */
+		q = kmixer_mix_clip(kmixer_mix_tpdf(v, &x, lsb)) &
+		    ~(lsb - 1);
+		err[c] = MAX(MIN(q - v, lim), -lim);
+		bus[i] = q;
+		if (++c == nch)
+			c = 0;
+	}
+	d->d_seed[0] = x;
+	memcpy(d->d_err, err, sizeof(err));
+}
+
+/*
+ * Accumulate nsamples samples already on a mix bus into another.
+ */
+void
+kmixer_mix_bus(int32_t *bus, const int32_t *src, u_int nsamples)
+{
+	u_int i;
+
+	for (i = 0; i < nsamples; i++)
+		bus[i] = kmixer_mix_sat((int64_t)bus[i] + src[i]);
+}
@@ -0,0 +1,97 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _KMIXER_MIX_H
+#define _KMIXER_MIX_H
+
+/*
+ * The mix bus holds one int32_t per sample.  Samples are scaled so that
+ * full scale is KMIXER_BUS_BITS wide; the remaining high bits are headroom
+ * for summing channels before the bus is clipped on output.
+ */
+#define KMIXER_BUS_BITS		24
+#define KMIXER_BUS_MAX		((1 << (KMIXER_BUS_BITS - 1)) - 1)
+#define KMIXER_BUS_MIN		(-(1 << (KMIXER_BUS_BITS - 1)))
+
+#define KMIXER_MIX_GAINBITS	16
+#define KMIXER_MIX_UNITY	(1 << KMIXER_MIX_GAINBITS)
+
+/*
+ * Gain applied while a channel is mixed, fixed point with
+ * KMIXER_MIX_GAINBITS fraction bits: r_gain[0] for the left of a
+ * stereo channel and for every channel of any other count, r_gain[1]
+ * for the right.  A new target is reached by a linear ramp, see
+ * kmixer_mix_ramp().
+ */
+struct kmixer_ramp {
+	int32_t			r_gain[2];
+	int32_t			r_target[2];
+	int32_t			r_step[2];	/* per frame */
+	u_int			r_frames;	/* left to ramp */
+};
+
+static inline bool
+kmixer_mix_unity(const struct kmixer_ramp *r)
+{
+	return r->r_frames == 0 && r->r_gain[0] == KMIXER_MIX_UNITY &&
+	    r->r_gain[1] == KMIXER_MIX_UNITY;
+}
+
+/* TPDF noise in 1/256 of an output LSB, from kmixer_mix_tables.h */
+#define KMIXER_TPDF_BITS	10
+#define KMIXER_TPDF_SIZE	(1 << KMIXER_TPDF_BITS)
+extern const int16_t kmixer_tpdf_table[KMIXER_TPDF_SIZE];
+
+/*
+ * Dither state of one output stream, see kmixer_mix_dither().  Plain
+ * TPDF draws from KMIXER_DITHER_LANES generators in turn, so that
+ * neighbouring samples do not wait on each other.
+ */
+#define KMIXER_DITHER_LANES	8
+
+struct kmixer_dither {
+	uint32_t		d_seed[KMIXER_DITHER_LANES]; /* never 0 */
+	bool			d_shape;	/* feed the error back */
+	int32_t			d_err[AUDIO_MAX_CHANNELS];
+};
+
+int	kmixer_mix_check_params(const struct audio_params *);
+void	kmixer_mix_ramp(struct kmixer_ramp *, const int32_t *, u_int);
+void	kmixer_mix_add(int32_t *, const uint8_t *,
+		       const struct audio_params *, u_int);
+void	kmixer_mix_add_gain(int32_t *, const uint8_t *,
+			    const struct audio_params *, u_int,
+			    struct kmixer_ramp *);
+void	kmixer_mix_out(uint8_t *, const int32_t *,
+		       const struct audio_params *, u_int);
+void	kmixer_mix_dither_init(struct kmixer_dither *, uint32_t);
+void	kmixer_mix_dither(int32_t *, const struct audio_params *, u_int,
+			  struct kmixer_dither *);
+void	kmixer_mix_bus(int32_t *, const int32_t *, u_int);
+
+#endif /* !_KMIXER_MIX_H */
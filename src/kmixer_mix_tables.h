@@ -0,0 +1,282 @@
+/* $NetBSD$ */
+
+/*
+ * Generated by bench/kmixer_gentables.c, do not edit.
+ * 8-bit samples to 16-bit linear, and TPDF dither.
+ */
+
+/* mu-law */
+static const int16_t kmixer_ulaw_table[256] = {
+	-32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956,
+	-23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764,
+	-15996, -15484, -14972, -14460, -13948, -13436, -12924, -12412,
+	-11900, -11388, -10876, -10364, -9852, -9340, -8828, -8316,
+	-7932, -7676, -7420, -7164, -6908, -6652, -6396, -6140,
+	-5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092,
+	-3900, -3772, -3644, -3516, -3388, -3260, -3132, -3004,
+	-2876, -2748, -2620, -2492, -2364, -2236, -2108, -1980,
+	-1884, -1820, -1756, -1692, -1628, -1564, -1500, -1436,
+	-1372, -1308, -1244, -1180, -1116, -1052, -988, -924,
+	-876, -844, -812, -780, -748, -716, -684, -652,
+	-620, -588, -556, -524, -492, -460, -428, -396,
+	-372, -356, -340, -324, -308, -292, -276, -260,
+	-244, -228, -212, -196, -180, -164, -148, -132,
+	-120, -112, -104, -96, -88, -80, -72, -64,
+	-56, -48, -40, -32, -24, -16, -8, 0,
+	32124, 31100, 30076, 29052, 28028, 27004, 25980, 24956,
+	23932, 22908, 21884, 20860, 19836, 18812, 17788, 16764,
+	15996, 15484, 14972, 14460, 13948, 13436, 12924, 12412,
+	11900, 11388, 10876, 10364, 9852, 9340, 8828, 8316,
+	7932, 7676, 7420, 7164, 6908, 6652, 6396, 6140,
+	5884, 5628, 5372, 5116, 4860, 4604, 4348, 4092,
+	3900, 3772, 3644, 3516, 3388, 3260, 3132, 3004,
+	2876, 2748, 2620, 2492, 2364, 2236, 2108, 1980,
+	1884, 1820, 1756, 1692, 1628, 1564, 1500, 1436,
+	1372, 1308, 1244, 1180, 1116, 1052, 988, 924,
+	876, 844, 812, 780, 748, 716, 684, 652,
+	620, 588, 556, 524, 492, 460, 428, 396,
+	372, 356, 340, 324, 308, 292, 276, 260,
+	244, 228, 212, 196, 180, 164, 148, 132,
+	120, 112, 104, 96, 88, 80, 72, 64,
+	56, 48, 40, 32, 24, 16, 8, 0,
+};
+
+/* A-law */
+static const int16_t kmixer_alaw_table[256] = {
+	-5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736,
+	-7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784,
+	-2752, -2624, -3008, -2880, -2240, -2112, -2496, -2368,
+	-3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392,
+	-22016, -20992, -24064, -23040, -17920, -16896, -19968, -18944,
+	-30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136,
+	-11008, -10496, -12032, -11520, -8960, -8448, -9984, -9472,
+	-15104, -14592, -16128, -15616, -13056, -12544, -14080, -13568,
+	-344, -328, -376, -360, -280, -264, -312, -296,
+	-472, -456, -504, -488, -408, -392, -440, -424,
+	-88, -72, -120, -104, -24, -8, -56, -40,
+	-216, -200, -248, -232, -152, -136, -184, -168,
+	-1376, -1312, -1504, -1440, -1120, -1056, -1248, -1184,
+	-1888, -1824, -2016, -1952, -1632, -1568, -1760, -1696,
+	-688, -656, -752, -720, -560, -528, -624, -592,
+	-944, -912, -1008, -976, -816, -784, -880, -848,
+	5504, 5248, 6016, 5760, 4480, 4224, 4992, 4736,
+	7552, 7296, 8064, 7808, 6528, 6272, 7040, 6784,
+	2752, 2624, 3008, 2880, 2240, 2112, 2496, 2368,
+	3776, 3648, 4032, 3904, 3264, 3136, 3520, 3392,
+	22016, 20992, 24064, 23040, 17920, 16896, 19968, 18944,
+	30208, 29184, 32256, 31232, 26112, 25088, 28160, 27136,
+	11008, 10496, 12032, 11520, 8960, 8448, 9984, 9472,
+	15104, 14592, 16128, 15616, 13056, 12544, 14080, 13568,
+	344, 328, 376, 360, 280, 264, 312, 296,
+	472, 456, 504, 488, 408, 392, 440, 424,
+	88, 72, 120, 104, 24, 8, 56, 40,
+	216, 200, 248, 232, 152, 136, 184, 168,
+	1376, 1312, 1504, 1440, 1120, 1056, 1248, 1184,
+	1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696,
+	688, 656, 752, 720, 560, 528, 624, 592,
+	944, 912, 1008, 976, 816, 784, 880, 848,
+};
+
+/* signed 8-bit */
+static const int16_t kmixer_slinear8_table[256] = {
+	0, 256, 512, 768, 1024, 1280, 1536, 1792,
+	2048, 2304, 2560, 2816, 3072, 3328, 3584, 3840,
+	4096, 4352, 4608, 4864, 5120, 5376, 5632, 5888,
+	6144, 6400, 6656, 6912, 7168, 7424, 7680, 7936,
+	8192, 8448, 8704, 8960, 9216, 9472, 9728, 9984,
+	10240, 10496, 10752, 11008, 11264, 11520, 11776, 12032,
+	12288, 12544, 12800, 13056, 13312, 13568, 13824, 14080,
+	14336, 14592, 14848, 15104, 15360, 15616, 15872, 16128,
+	16384, 16640, 16896, 17152, 17408, 17664, 17920, 18176,
+	18432, 18688, 18944, 19200, 19456, 19712, 19968, 20224,
+	20480, 20736, 20992, 21248, 21504, 21760, 22016, 22272,
+	22528, 22784, 23040, 23296, 23552, 23808, 24064, 24320,
+	24576, 24832, 25088, 25344, 25600, 25856, 26112, 26368,
+	26624, 26880, 27136, 27392, 27648, 27904, 28160, 28416,
+	28672, 28928, 29184, 29440, 29696, 29952, 30208, 30464,
+	30720, 30976, 31232, 31488, 31744, 32000, 32256, 32512,
+	-32768, -32512, -32256, -32000, -31744, -31488, -31232, -30976,
+	-30720, -30464, -30208, -29952, -29696, -29440, -29184, -28928,
+	-28672, -28416, -28160, -27904, -27648, -27392, -27136, -26880,
+	-26624, -26368, -26112, -25856, -25600, -25344, -25088, -24832,
+	-24576, -24320, -24064, -23808, -23552, -23296, -23040, -22784,
+	-22528, -22272, -22016, -21760, -21504, -21248, -20992, -20736,
+	-20480, -20224, -19968, -19712, -19456, -19200, -18944, -18688,
+	-18432, -18176, -17920, -17664, -17408, -17152, -16896, -16640,
+	-16384, -16128, -15872, -15616, -15360, -15104, -14848, -14592,
+	-14336, -14080, -13824, -13568, -13312, -13056, -12800, -12544,
+	-12288, -12032, -11776, -11520, -11264, -11008, -10752, -10496,
+	-10240, -9984, -9728, -9472, -9216, -8960, -8704, -8448,
+	-8192, -7936, -7680, -7424, -7168, -6912, -6656, -6400,
+	-6144, -5888, -5632, -5376, -5120, -4864, -4608, -4352,
+	-4096, -3840, -3584, -3328, -3072, -2816, -2560, -2304,
+	-2048, -1792, -1536, -1280, -1024, -768, -512, -256,
+};
+
+/* unsigned 8-bit */
+static const int16_t kmixer_ulinear8_table[256] = {
+	-32768, -32512, -32256, -32000, -31744, -31488, -31232, -30976,
+	-30720, -30464, -30208, -29952, -29696, -29440, -29184, -28928,
+	-28672, -28416, -28160, -27904, -27648, -27392, -27136, -26880,
+	-26624, -26368, -26112, -25856, -25600, -25344, -25088, -24832,
+	-24576, -24320, -24064, -23808, -23552, -23296, -23040, -22784,
+	-22528, -22272, -22016, -21760, -21504, -21248, -20992, -20736,
+	-20480, -20224, -19968, -19712, -19456, -19200, -18944, -18688,
+	-18432, -18176, -17920, -17664, -17408, -17152, -16896, -16640,
+	-16384, -16128, -15872, -15616, -15360, -15104, -14848, -14592,
+	-14336, -14080, -13824, -13568, -13312, -13056, -12800, -12544,
+	-12288, -12032, -11776, -11520, -11264, -11008, -10752, -10496,
+	-10240, -9984, -9728, -9472, -9216, -8960, -8704, -8448,
+	-8192, -7936, -7680, -7424, -7168, -6912, -6656, -6400,
+	-6144, -5888, -5632, -5376, -5120, -4864, -4608, -4352,
+	-4096, -3840, -3584, -3328, -3072, -2816, -2560, -2304,
+	-2048, -1792, -1536, -1280, -1024, -768, -512, -256,
+	0, 256, 512, 768, 1024, 1280, 1536, 1792,
+	2048, 2304, 2560, 2816, 3072, 3328, 3584, 3840,
+	4096, 4352, 4608, 4864, 5120, 5376, 5632, 5888,
+	6144, 6400, 6656, 6912, 7168, 7424, 7680, 7936,
+	8192, 8448, 8704, 8960, 9216, 9472, 9728, 9984,
+	10240, 10496, 10752, 11008, 11264, 11520, 11776, 12032,
+	12288, 12544, 12800, 13056, 13312, 13568, 13824, 14080,
+	14336, 14592, 14848, 15104, 15360, 15616, 15872, 16128,
+	16384, 16640, 16896, 17152, 17408, 17664, 17920, 18176,
+	18432, 18688, 18944, 19200, 19456, 19712, 19968, 20224,
+	20480, 20736, 20992, 21248, 21504, 21760, 22016, 22272,
+	22528, 22784, 23040, 23296, 23552, 23808, 24064, 24320,
+	24576, 24832, 25088, 25344, 25600, 25856, 26112, 26368,
+	26624, 26880, 27136, 27392, 27648, 27904, 28160, 28416,
+	28672, 28928, 29184, 29440, 29696, 29952, 30208, 30464,
+	30720, 30976, 31232, 31488, 31744, 32000, 32256, 32512,
+};
+
+/* TPDF noise, 1/256 LSB */
+const int16_t kmixer_tpdf_table[KMIXER_TPDF_SIZE] = {
+	-105, 105, 4, -4, 188, -188, 39, -39,
+	-114, 114, -119, 119, -56, 56, -32, 32,
+	-14, 14, 9, -9, 56, -56, 63, -63,
+	109, -109, -8, 8, -107, 107, -162, 162,
+	7, -7, 64, -64, -195, 195, -65, 65,
+	2, -2, -12, 12, 67, -67, -76, 76,
+	-70, 70, -44, 44, 197, -197, 102, -102,
+	149, -149, -56, 56, -23, 23, -170, 170,
+	205, -205, -164, 164, -10, 10, -61, 61,
+	169, -169, -110, 110, -182, 182, 32, -32,
+	-12, 12, 19, -19, -234, 234, 93, -93,
+	-81, 81, 53, -53, -30, 30, -174, 174,
+	199, -199, -78, 78, 24, -24, -85, 85,
+	-59, 59, 52, -52, -179, 179, -2, 2,
+	-211, 211, -47, 47, 43, -43, 37, -37,
+	64, -64, -104, 104, -30, 30, 104, -104,
+	-214, 214, 50, -50, -53, 53, -148, 148,
+	-142, 142, -13, 13, -164, 164, -107, 107,
+	52, -52, 60, -60, -55, 55, 142, -142,
+	53, -53, 7, -7, -110, 110, 4, -4,
+	-19, 19, -153, 153, -182, 182, 147, -147,
+	-97, 97, 5, -5, -46, 46, -135, 135,
+	-25, 25, -8, 8, 189, -189, 23, -23,
+	-118, 118, 81, -81, 190, -190, -60, 60,
+	-42, 42, -192, 192, -103, 103, -32, 32,
+	2, -2, 30, -30, -43, 43, 131, -131,
+	-85, 85, 203, -203, 46, -46, -60, 60,
+	-203, 203, 110, -110, -144, 144, -74, 74,
+	-152, 152, 39, -39, 128, -128, -145, 145,
+	-56, 56, 108, -108, 9, -9, 122, -122,
+	145, -145, 72, -72, 20, -20, -95, 95,
+	-112, 112, 4, -4, 52, -52, -91, 91,
+	100, -100, -73, 73, 49, -49, -7, 7,
+	51, -51, -121, 121, -14, 14, 28, -28,
+	-34, 34, -199, 199, -216, 216, 2, -2,
+	-50, 50, 124, -124, -40, 40, -37, 37,
+	73, -73, -40, 40, 76, -76, -101, 101,
+	114, -114, 176, -176, -133, 133, 126, -126,
+	-79, 79, 56, -56, -121, 121, 132, -132,
+	180, -180, 199, -199, -208, 208, -18, 18,
+	19, -19, -159, 159, -128, 128, 48, -48,
+	-34, 34, -25, 25, -131, 131, -50, 50,
+	7, -7, 5, -5, -24, 24, 87, -87,
+	-64, 64, -6, 6, 21, -21, -67, 67,
+	154, -154, -190, 190, 95, -95, 113, -113,
+	-4, 4, -15, 15, 147, -147, 187, -187,
+	-17, 17, 35, -35, 89, -89, -38, 38,
+	-176, 176, 56, -56, 89, -89, -71, 71,
+	84, -84, 148, -148, 186, -186, -28, 28,
+	-31, 31, 131, -131, -51, 51, -49, 49,
+	-42, 42, 111, -111, 9, -9, 97, -97,
+	159, -159, -190, 190, 31, -31, 95, -95,
+	56, -56, -2, 2, -132, 132, -72, 72,
+	143, -143, -21, 21, 36, -36, 85, -85,
+	156, -156, -177, 177, -24, 24, -36, 36,
+	-9, 9, -89, 89, 109, -109, -16, 16,
+	98, -98, 35, -35, -96, 96, 11, -11,
+	-203, 203, 16, -16, -27, 27, 56, -56,
+	-93, 93, 28, -28, -131, 131, 72, -72,
+	-197, 197, 13, -13, -185, 185, -15, 15,
+	-115, 115, -58, 58, -76, 76, 84, -84,
+	7, -7, 85, -85, 140, -140, 6, -6,
+	28, -28, -70, 70, -12, 12, 122, -122,
+	-40, 40, 29, -29, -58, 58, 115, -115,
+	3, -3, 116, -116, 54, -54, -34, 34,
+	56, -56, -2, 2, 33, -33, 127, -127,
+	-1, 1, 138, -138, 20, -20, -78, 78,
+	109, -109, 49, -49, -135, 135, 38, -38,
+	-202, 202, -85, 85, 9, -9, -77, 77,
+	35, -35, 66, -66, -5, 5, -19, 19,
+	48, -48, -114, 114, 159, -159, -33, 33,
+	177, -177, -230, 230, -100, 100, 54, -54,
+	-179, 179, -63, 63, 112, -112, -158, 158,
+	-49, 49, -2, 2, -232, 232, -4, 4,
+	34, -34, -25, 25, 37, -37, -181, 181,
+	-226, 226, -53, 53, 14, -14, 35, -35,
+	-77, 77, -61, 61, 93, -93, 118, -118,
+	-213, 213, -62, 62, 2, -2, -129, 129,
+	59, -59, -123, 123, -50, 50, -82, 82,
+	-33, 33, 31, -31, -2, 2, 99, -99,
+	-62, 62, -146, 146, 97, -97, -124, 124,
+	95, -95, -15, 15, 147, -147, 55, -55,
+	141, -141, 99, -99, 79, -79, 109, -109,
+	-159, 159, 200, -200, 74, -74, 53, -53,
+	36, -36, 21, -21, -114, 114, -12, 12,
+	58, -58, -146, 146, 49, -49, -201, 201,
+	-89, 89, 0, 0, 67, -67, 39, -39,
+	-201, 201, 186, -186, -81, 81, 50, -50,
+	36, -36, -58, 58, -102, 102, -42, 42,
+	-83, 83, 34, -34, -157, 157, 72, -72,
+	-85, 85, 128, -128, -81, 81, -15, 15,
+	-6, 6, 234, -234, -44, 44, -110, 110,
+	-25, 25, -121, 121, -64, 64, -66, 66,
+	-1, 1, -38, 38, 20, -20, -151, 151,
+	49, -49, 119, -119, -57, 57, -72, 72,
+	51, -51, -22, 22, -6, 6, -20, 20,
+	135, -135, 203, -203, 62, -62, 120, -120,
+	139, -139, 232, -232, -24, 24, 85, -85,
+	-42, 42, -134, 134, -7, 7, 169, -169,
+	-59, 59, -23, 23, -35, 35, 184, -184,
+	-246, 246, -35, 35, -109, 109, -115, 115,
+	37, -37, -97, 97, 107, -107, -115, 115,
+	-61, 61, -51, 51, -150, 150, 44, -44,
+	-68, 68, -13, 13, 37, -37, -50, 50,
+	131, -131, -32, 32, 7, -7, 64, -64,
+	94, -94, 52, -52, 180, -180, -78, 78,
+	112, -112, 149, -149, -92, 92, -5, 5,
+	-10, 10, 6, -6, 46, -46, -180, 180,
+	-16, 16, -50, 50, -29, 29, 59, -59,
+	-60, 60, 169, -169, -61, 61, 25, -25,
+	-94, 94, -39, 39, -69, 69, -75, 75,
+	206, -206, -105, 105, 83, -83, 44, -44,
+	11, -11, -36, 36, 112, -112, -13, 13,
+	-30, 30, -186, 186, -87, 87, 81, -81,
+	44, -44, -155, 155, -35, 35, 110, -110,
+	31, -31, 57, -57, 114, -114, -43, 43,
+	-112, 112, 5, -5, 34, -34, 162, -162,
+	56, -56, -16, 16, 20, -20, 5, -5,
+	-137, 137, 29, -29, -7, 7, 124, -124,
+	26, -26, 224, -224, -38, 38, -70, 70,
+	-51, 51, 127, -127, -74, 74, -56, 56,
+	-125, 125, 54, -54, 213, -213, -127, 127,
+	8, -8, 173, -173, -125, 125, -170, 170,
+	-38, 38, 203, -203, 149, -149, -101, 101,
+	-57, 57, -50, 50, -200, 200, -51, 51,
+	110, -110, -37, 37, -44, 44, 129, -129,
+	79, -79, -149, 149, 76, -76, 144, -144,
+	-7, 7, -56, 56, 212, -212, -194, 194,
+};
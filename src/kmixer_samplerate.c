@@ -45,11 +45,20 @@ __KERNEL_RCSID(0, "$NetBSD: aurateconv.c,v 1.9 2003/12/31 13:51:28 bjh21 Exp $")
 #include <sys/errno.h>
 #include <sys/select.h>
 #include <sys/audioio.h>
+#include <sys/kmem.h>
+#include <sys/mutex.h>
+#include <sys/queue.h>
+#include <sys/endian.h>
 
 #include <dev/audio_if.h>
 #include <dev/audiovar.h>
 
 #include "kmixer_samplerate.h"
+#include "kmixer_samplerate_sinc.h"
+#include "kmixer_format.h"
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+#include "kmixerio.h"
 
 #ifdef KMIXER_SAMPLERATE_DEBUG
 #define DPRINTF(x)	printf x
@@ -57,39 +66,53 @@ __KERNEL_RCSID(0, "$NetBSD: aurateconv.c,v 1.9 2003/12/31 13:51:28 bjh21 Exp $")
 #define DPRINTF(x)
 #endif
 
-static int kmixer_samplerate_play_slinear16_LE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-static int kmixer_samplerate_play_slinear24_LE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-static int kmixer_samplerate_play_slinear16_BE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-static int kmixer_samplerate_play_slinear24_BE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-
-static int kmixer_samplerate_record_slinear16_LE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-static int kmixer_samplerate_record_slinear24_LE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-static int kmixer_samplerate_record_slinear16_BE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
-static int kmixer_samplerate_record_slinear24_BE(
-	struct kmixer_samplerate_context *,
-	const struct audio_params *, const struct audio_params *,
-	uint8_t *, const uint8_t *, int);
+/* bounds on the coefficient table for extreme rate ratios */
+#define KMIXER_SAMPLERATE_MAXPHASES	1024
+#define KMIXER_SAMPLERATE_MAXTAPS	256
+#define KMIXER_SAMPLERATE_COEF_BITS	24
+
+/* phases enough for a drifting ratio to move by fractions of a frame */
+#define KMIXER_SAMPLERATE_MINPHASES	256
+
+/*
+ * A polyphase filter converts f_from Hz to f_to Hz.  With the ratio
+ * reduced to f_up/f_down, output frame n lies at input position
+ * n * f_down / f_up, and the fractional part of that position selects
+ * one of f_nphases coefficient sets.  Filters are shared by every
+ * context converting between the same rates at the same quality.
+ */
+struct kmixer_samplerate_filter {
+	LIST_ENTRY(kmixer_samplerate_filter) f_entry;
+	u_int		f_refcnt;
+	long		f_from;
+	long		f_to;
+	int		f_quality;
+	u_int		f_up;
+	u_int		f_down;
+	u_int		f_nphases;
+	u_int		f_ntaps;
+	int32_t		*f_coef;	/* f_nphases * f_ntaps, Q24 */
+};
+
+static LIST_HEAD(, kmixer_samplerate_filter) kmixer_samplerate_filters =
+    LIST_HEAD_INITIALIZER(kmixer_samplerate_filters);
+static kmutex_t kmixer_samplerate_lock;
+
+static int kmixer_samplerate_select(struct kmixer_samplerate_context *,
+	const struct audio_params *, const struct audio_params *);
+
+void
+kmixer_samplerate_init(void)
+{
+	mutex_init(&kmixer_samplerate_lock, MUTEX_DEFAULT, IPL_NONE);
+}
+
+void
+kmixer_samplerate_fini(void)
+{
+	KASSERT(LIST_EMPTY(&kmixer_samplerate_filters));
+	mutex_destroy(&kmixer_samplerate_lock);
+}
 
 int
 kmixer_samplerate_check_params(const struct audio_params *from,
@@ -104,10 +127,21 @@ kmixer_samplerate_check_params(const struct audio_params *from,
 	    && to->sample_rate == from->sample_rate)
 		return 0;	/* No conversion */
 
-	if ((to->encoding != AUDIO_ENCODING_SLINEAR_LE
-	     && to->encoding != AUDIO_ENCODING_SLINEAR_BE)
-	    || (to->precision != 16 && to->precision != 24))
+	switch (to->encoding) {
+	case AUDIO_ENCODING_SLINEAR_LE:
+	case AUDIO_ENCODING_SLINEAR_BE:
+		if (to->precision != 16 && to->precision != 24
+		    && to->precision != 32)
+			return (EINVAL);
+		break;
+	case KMIXER_ENCODING_FLOAT_LE:
+	case KMIXER_ENCODING_FLOAT_BE:
+		if (to->precision != 32)
+			return (EINVAL);
+		break;
+	default:
 		return (EINVAL);
+	}
 
 	if (to->channels != from->channels) {
 		if (to->channels == 1 && from->channels == 2) {
@@ -129,14 +163,154 @@ kmixer_samplerate_check_params(const struct audio_params *from,
 	return 0;
 }
 
-void
+static long
+kmixer_samplerate_gcd(long a, long b)
+{
+	long t;
+
+	while (b != 0) {
+		t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/*
+ * Fill in the per-phase coefficients of a filter from one of the
+ * prototype sinc tables.  When downsampling the prototype is stretched
+ * to the output Nyquist frequency, which takes proportionally more taps.
+ * Every phase is normalised to unity gain at DC.
+ */
+static void
+kmixer_samplerate_filter_compute(struct kmixer_samplerate_filter *f,
+    const int32_t *proto, u_int zeros)
+{
+	const uint64_t fcnum = MIN(f->f_up, f->f_down);
+	const uint64_t fcden = f->f_down;
+	const uint64_t end = (uint64_t)zeros * KMIXER_SINC_OVERSAMPLE;
+	int32_t *c;
+	int64_t d, sum;
+	uint64_t x, frac, i;
+	u_int p, k;
+
+	for (p = 0; p < f->f_nphases; p++) {
+		c = f->f_coef + p * f->f_ntaps;
+		frac = ((uint64_t)p << 16) / f->f_nphases;
+		sum = 0;
+		for (k = 0; k < f->f_ntaps; k++) {
+			/* distance from the output position, Q16 frames */
+			d = (((int64_t)k - (f->f_ntaps / 2 - 1)) << 16) - frac;
+			if (d < 0)
+				d = -d;
+			/* prototype index, Q16 */
+			x = (uint64_t)d * KMIXER_SINC_OVERSAMPLE * fcnum / fcden;
+			i = x >> 16;
+			if (i >= end) {
+				c[k] = 0;
+				continue;
+			}
+			c[k] = proto[i] + ((((int64_t)proto[i + 1] - proto[i]) *
+			    (int64_t)(x & 0xffff)) >> 16);
+			sum += c[k];
+		}
+		for (k = 0; k < f->f_ntaps; k++)
+			c[k] = ((int64_t)c[k] << KMIXER_SAMPLERATE_COEF_BITS) /
+			    sum;
+	}
+}
+
+static struct kmixer_samplerate_filter *
+kmixer_samplerate_filter_get(long from, long to, int quality)
+{
+	struct kmixer_samplerate_filter *f;
+	const int32_t *proto;
+	u_int zeros, mult;
+	long g;
+
+	mutex_enter(&kmixer_samplerate_lock);
+	LIST_FOREACH(f, &kmixer_samplerate_filters, f_entry) {
+		if (f->f_from == from && f->f_to == to &&
+		    f->f_quality == quality) {
+			f->f_refcnt++;
+			mutex_exit(&kmixer_samplerate_lock);
+			return f;
+		}
+	}
+
+	if (quality == KMIXER_SAMPLERATE_LONG) {
+		proto = kmixer_sinc_long;
+		zeros = KMIXER_SINC_LONG_ZEROS;
+	} else {
+		proto = kmixer_sinc_short;
+		zeros = KMIXER_SINC_SHORT_ZEROS;
+	}
+
+	g = kmixer_samplerate_gcd(from, to);
+	f = kmem_zalloc(sizeof(*f), KM_SLEEP);
+	f->f_refcnt = 1;
+	f->f_from = from;
+	f->f_to = to;
+	f->f_quality = quality;
+	mult = howmany(KMIXER_SAMPLERATE_MINPHASES, to / g);
+	f->f_up = to / g * mult;
+	f->f_down = from / g * mult;
+	f->f_nphases = MIN(f->f_up, KMIXER_SAMPLERATE_MAXPHASES);
+	f->f_ntaps = 2 * zeros;
+	if (f->f_down > f->f_up)
+		f->f_ntaps = 2 * howmany((uint64_t)zeros * f->f_down,
+		    f->f_up);
+	f->f_ntaps = MIN(f->f_ntaps, KMIXER_SAMPLERATE_MAXTAPS);
+	f->f_coef = kmem_alloc(f->f_nphases * f->f_ntaps * sizeof(int32_t),
+	    KM_SLEEP);
+	kmixer_samplerate_filter_compute(f, proto, zeros);
+
+	DPRINTF(("kmixer_samplerate_filter_get: %ld:%ld %u/%u phases=%u "
+		 "taps=%u\n", from, to, f->f_up, f->f_down, f->f_nphases,
+		 f->f_ntaps));
+
+	LIST_INSERT_HEAD(&kmixer_samplerate_filters, f, f_entry);
+	mutex_exit(&kmixer_samplerate_lock);
+
+	return f;
+}
+
+static void
+kmixer_samplerate_filter_put(struct kmixer_samplerate_filter *f)
+{
+	mutex_enter(&kmixer_samplerate_lock);
+	if (--f->f_refcnt > 0) {
+		mutex_exit(&kmixer_samplerate_lock);
+		return;
+	}
+	LIST_REMOVE(f, f_entry);
+	mutex_exit(&kmixer_samplerate_lock);
+
+	kmem_free(f->f_coef, f->f_nphases * f->f_ntaps * sizeof(int32_t));
+	kmem_free(f, sizeof(*f));
+}
+
+/*
+ * src and dst are the formats on either side of the converter in the
+ * direction the data flows: client to hardware when playing, hardware to
+ * client when recording.  The kernel for them is chosen here once, so the
+ * conversion itself never looks at the formats again.
+ */
+int
 kmixer_samplerate_init_context(struct kmixer_samplerate_context *context,
-    long src_rate, long dst_rate, uint8_t *start, uint8_t *end)
+    const struct audio_params *src, const struct audio_params *dst,
+    int quality, bool steer, uint8_t *start, uint8_t *end)
 {
+	const long src_rate = src->sample_rate;
+	const long dst_rate = dst->sample_rate;
+	const u_int channels = src->channels;
 	int i;
 
 	context->ring_start = start;
 	context->ring_end = end;
+	context->steer = steer;
+	context->drift = 0;
+	context->dfrac = 0;
 	if (dst_rate > src_rate) {
 		context->count = src_rate;
 	} else {
@@ -144,148 +318,160 @@ kmixer_samplerate_init_context(struct kmixer_samplerate_context *context,
 	}
 	for (i = 0; i < AUDIO_MAX_CHANNELS; i++)
 		context->prev[i] = 0;
-}
+	context->filter = NULL;
+	context->hist = NULL;
+	context->histsize = 0;
+	context->hpos = 0;
+	context->bounce = NULL;
+	context->bouncesize = 0;
 
-/*
- * src is a ring buffer.
- */
-int
-kmixer_samplerate_record(struct kmixer_samplerate_context *context,
-    const struct audio_params *from, const struct audio_params *to,
-    uint8_t *dest, const uint8_t *src, int srcsize)
-{
-	if (to->sample_rate == from->sample_rate
-	    && to->channels == from->channels) {
-		int n;
-
-		n = context->ring_end - src;
-		if (srcsize <= n)
-			memcpy(dest, src, srcsize);
-		else {
-			memcpy(dest, src, n);
-			memcpy(dest + n, context->ring_start, srcsize - n);
-		}
-		return srcsize;
+	context->src_rate = src_rate;
+	context->dst_rate = dst_rate;
+	context->sch = src->channels;
+	context->dch = dst->channels;
+	context->sfsize = src->channels * src->precision / NBBY;
+	context->dfsize = dst->channels * dst->precision / NBBY;
+	if (kmixer_samplerate_select(context, src, dst) != 0)
+		return EINVAL;
+
+	if (start != NULL && src_rate > 0 && dst_rate > 0) {
+		context->bouncesize = kmixer_samplerate_maxout(src_rate,
+		    dst_rate, 1) * context->dfsize;
+		context->bounce = kmem_alloc(context->bouncesize, KM_SLEEP);
 	}
 
-	switch (to->encoding) {
-	case AUDIO_ENCODING_SLINEAR_LE:
-		switch (to->precision) {
-		case 16:
-			return kmixer_samplerate_record_slinear16_LE(context,
-			    from, to, dest, src, srcsize);
-		case 24:
-			return kmixer_samplerate_record_slinear24_LE(context,
-			    from, to, dest, src, srcsize);
-		}
-		break;
-	case AUDIO_ENCODING_SLINEAR_BE:
-		switch (to->precision) {
-		case 16:
-			return kmixer_samplerate_record_slinear16_BE(context,
-			    from, to, dest, src, srcsize);
-		case 24:
-			return kmixer_samplerate_record_slinear24_BE(context,
-			    from, to, dest, src, srcsize);
-		}
+	switch (quality) {
+	case KMIXER_SAMPLERATE_LINEAR:
+		return 0;
+	case KMIXER_SAMPLERATE_SHORT:
+	case KMIXER_SAMPLERATE_LONG:
 		break;
 	default:
-		/* This should be rejected in kmixer_samplerate_check_params */
-		printf("kmixer_samplerate_record: unimplemented encoding: %d\n",
-		       to->encoding);
-		return 0;
+		return EINVAL;
 	}
-	printf("kmixer_samplerate_record: unimplemented precision: %d\n",
-	       to->precision);
+	if (src_rate == dst_rate && !steer)
+		return 0;
+	if (src_rate <= 0 || dst_rate <= 0 || channels == 0
+	    || channels > AUDIO_MAX_CHANNELS)
+		return EINVAL;
+
+	/* count is the output phase, in units of 1/f_up input frames */
+	context->count = 0;
+	context->filter = kmixer_samplerate_filter_get(src_rate, dst_rate,
+	    quality);
+	context->histsize = 2 * context->filter->f_ntaps * channels *
+	    sizeof(int32_t);
+	context->hist = kmem_zalloc(context->histsize, KM_SLEEP);
 	return 0;
 }
 
 /*
- * dest is a ring buffer.
+ * Stretch the rate ratio of a steered context: drift / 2^32 more source
+ * frames are taken per output frame, fewer if negative.  The mixer uses
+ * it to follow a device whose clock is not quite at its nominal rate.
  */
-int
-kmixer_samplerate_play(struct kmixer_samplerate_context *context,
-    const struct audio_params *from, const struct audio_params *to,
-    uint8_t *dest, const uint8_t *src, int srcsize)
+void
+kmixer_samplerate_set_drift(struct kmixer_samplerate_context *context,
+    int32_t drift)
 {
-	int n;
-
-	if (to->sample_rate == from->sample_rate
-	    && to->channels == from->channels) {
-		n = context->ring_end - dest;
-		if (srcsize <= n) {
-			memcpy(dest, src, srcsize);
-		} else {
-			memcpy(dest, src, n);
-			memcpy(context->ring_start, src + n, srcsize - n);
-		}
-		return srcsize;
-	}
+	if (!context->steer)
+		return;
+	context->drift = MIN(MAX(drift, -KMIXER_SAMPLERATE_MAXDRIFT),
+	    KMIXER_SAMPLERATE_MAXDRIFT);
+}
 
-	switch (to->encoding) {
-	case AUDIO_ENCODING_SLINEAR_LE:
-		switch (to->precision) {
-		case 16:
-			return kmixer_samplerate_play_slinear16_LE(context,
-			    from, to, dest, src, srcsize);
-		case 24:
-			return kmixer_samplerate_play_slinear24_LE(context,
-			    from, to, dest, src, srcsize);
-		}
-		break;
-	case AUDIO_ENCODING_SLINEAR_BE:
-		switch (to->precision) {
-		case 16:
-			return kmixer_samplerate_play_slinear16_BE(context,
-			    from, to, dest, src, srcsize);
-		case 24:
-			return kmixer_samplerate_play_slinear24_BE(context,
-			    from, to, dest, src, srcsize);
-		}
-		break;
-	default:
-		/* This should be rejected in kmixer_samplerate_check_params */
-		printf("kmixer_samplerate_play: unimplemented encoding: %d\n",
-		       to->encoding);
-		return 0;
+/*
+ * The conversion phase step for one output frame, stretched by the
+ * drift.  The fraction of a step unit left over is carried to the next
+ * frame.
+ */
+static inline long
+kmixer_samplerate_step(struct kmixer_samplerate_context *context, long step)
+{
+	int64_t acc;
+
+	if (context->drift == 0)
+		return step;
+	acc = (int64_t)context->dfrac + (int64_t)step * context->drift;
+	context->dfrac = (uint32_t)acc;
+
+	return step + (acc >> 32);
+}
+
+void
+kmixer_samplerate_destroy_context(struct kmixer_samplerate_context *context)
+{
+	if (context->filter != NULL) {
+		kmixer_samplerate_filter_put(context->filter);
+		context->filter = NULL;
+	}
+	if (context->hist != NULL) {
+		kmem_free(context->hist, context->histsize);
+		context->hist = NULL;
+	}
+	if (context->bounce != NULL) {
+		kmem_free(context->bounce, context->bouncesize);
+		context->bounce = NULL;
 	}
-	printf("kmixer_samplerate_play: unimplemented precision: %d\n",
-	       to->precision);
-	return 0;
 }
 
+/*
+ * Append one frame to the FIR history.  Each channel keeps its history
+ * twice over, so the last f_ntaps samples are always contiguous starting
+ * at hpos.
+ */
+static inline void
+kmixer_samplerate_fir_push(struct kmixer_samplerate_context *context,
+    const int32_t *v, int nch)
+{
+	const u_int ntaps = context->filter->f_ntaps;
+	int32_t *h;
+	int i;
 
-#define RING_CHECK(C, V)	\
-	do { \
-		if (V >= (C)->ring_end) \
-			V = (C)->ring_start; \
-	} while (/*CONSTCOND*/ 0)
+	h = context->hist;
+	for (i = 0; i < nch; i++, h += 2 * ntaps)
+		h[context->hpos] = h[context->hpos + ntaps] = v[i];
+	if (++context->hpos == ntaps)
+		context->hpos = 0;
+}
+
+/*
+ * Compute one output frame at the current phase.
+ */
+static inline void
+kmixer_samplerate_fir(const struct kmixer_samplerate_context *context,
+    int32_t *v, int nch, int bits)
+{
+	const struct kmixer_samplerate_filter *f = context->filter;
+	const int64_t max = ((int64_t)1 << (bits - 1)) - 1, min = -max - 1;
+	const int32_t *c, *h;
+	int64_t acc;
+	u_int k;
+	int i;
+
+	if (f->f_nphases == f->f_up)
+		c = f->f_coef + context->count * f->f_ntaps;
+	else
+		c = f->f_coef + (uint64_t)context->count * f->f_nphases /
+		    f->f_up * f->f_ntaps;
+	h = context->hist + context->hpos;
+	for (i = 0; i < nch; i++, h += 2 * f->f_ntaps) {
+		acc = 1 << (KMIXER_SAMPLERATE_COEF_BITS - 1);
+		for (k = 0; k < f->f_ntaps; k++)
+			acc += (int64_t)h[k] * c[k];
+		acc >>= KMIXER_SAMPLERATE_COEF_BITS;
+		v[i] = acc > max ? max : acc < min ? min : acc;
+	}
+}
 
 #define READ_S8LE(P)		*(const int8_t*)(P)
 #define WRITE_S8LE(P, V)	*(int8_t*)(P) = V
 #define READ_S8BE(P)		*(const int8_t*)(P)
 #define WRITE_S8BE(P, V)	*(int8_t*)(P) = V
-#if BYTE_ORDER == LITTLE_ENDIAN
-# define READ_S16LE(P)		*(const int16_t*)(P)
-# define WRITE_S16LE(P, V)	*(int16_t*)(P) = V
-# define READ_S16BE(P)		(int16_t)((P)[0] | ((P)[1]<<8))
-# define WRITE_S16BE(P, V)	\
-	do { \
-		int vv = V; \
-		(P)[0] = vv; \
-		(P)[1] = vv >> 8; \
-	} while (/*CONSTCOND*/ 0)
-#else
-# define READ_S16LE(P)		(int16_t)((P)[0] | ((P)[1]<<8))
-# define WRITE_S16LE(P, V)	\
-	do { \
-		int vv = V; \
-		(P)[0] = vv; \
-		(P)[1] = vv >> 8; \
-	} while (/*CONSTCOND*/ 0)
-# define READ_S16BE(P)		*(const int16_t*)(P)
-# define WRITE_S16BE(P, V)	*(int16_t*)(P) = V
-#endif
+#define READ_S16LE(P)		(int16_t)le16dec(P)
+#define WRITE_S16LE(P, V)	le16enc(P, (uint16_t)(V))
+#define READ_S16BE(P)		(int16_t)be16dec(P)
+#define WRITE_S16BE(P, V)	be16enc(P, (uint16_t)(V))
 #define READ_S24LE(P)		(int32_t)((P)[0] | ((P)[1]<<8) | (((int8_t)((P)[2]))<<16))
 #define WRITE_S24LE(P, V)	\
 	do { \
@@ -302,94 +488,119 @@ kmixer_samplerate_play(struct kmixer_samplerate_context *context,
 		(P)[1] = vvv >> 8; \
 		(P)[2] = vvv; \
 	} while (/*CONSTCOND*/ 0)
+#define READ_S32LE(P)		(int32_t)le32dec(P)
+#define WRITE_S32LE(P, V)	le32enc(P, (uint32_t)(V))
+#define READ_S32BE(P)		(int32_t)be32dec(P)
+#define WRITE_S32BE(P, V)	be32enc(P, (uint32_t)(V))
+#define READ_F32LE(P)		kmixer_float_to_s32(le32dec(P))
+#define WRITE_F32LE(P, V)	le32enc(P, kmixer_s32_to_float(V))
+#define READ_F32BE(P)		kmixer_float_to_s32(be32dec(P))
+#define WRITE_F32BE(P, V)	be32enc(P, kmixer_s32_to_float(V))
+
+/* 32-bit samples need 64-bit intermediates */
+#define MEAN2(BITS, A, B)	\
+	((BITS) > 24 ? (int32_t)(((int64_t)(A) + (B)) / 2) : ((A) + (B)) / 2)
+#define LERP(BITS, C256, N, P)	\
+	((BITS) > 24 ? \
+	 (int32_t)(((int64_t)(C256) * (N) + (int64_t)(256 - (C256)) * (P)) >> 8) : \
+	 ((C256) * (N) + (256 - (C256)) * (P)) >> 8)
 
-#define P_READ_Sn(BITS, EN, V, RP, FROM, TO)	\
+/*
+ * Channel maps, from the source channels to the destination channels.
+ * MONO, STEREO and DUP have the counts built in; the others take them
+ * from the context.
+ */
+#define KMIXER_SAMPLERATE_MAP_MONO	0	/* 1 -> 1 */
+#define KMIXER_SAMPLERATE_MAP_STEREO	1	/* 2 -> 2 */
+#define KMIXER_SAMPLERATE_MAP_COPY	2	/* n -> n */
+#define KMIXER_SAMPLERATE_MAP_DUP	3	/* 1 -> 2 */
+#define KMIXER_SAMPLERATE_MAP_MONOPAD	4	/* 1 -> n, n > 2, rest silent */
+#define KMIXER_SAMPLERATE_MAP_PAD	5	/* m -> n, 1 < m < n, rest silent */
+#define KMIXER_SAMPLERATE_MAP_DOWNMIX	6	/* n -> 1, mean of first two */
+#define KMIXER_SAMPLERATE_MAP_DROP	7	/* m -> n, 1 < n < m, first n */
+#define KMIXER_SAMPLERATE_NMAPS		8
+
+#define MAP_SCH(MAP, C)	\
+	((MAP) == KMIXER_SAMPLERATE_MAP_MONO || \
+	 (MAP) == KMIXER_SAMPLERATE_MAP_DUP || \
+	 (MAP) == KMIXER_SAMPLERATE_MAP_MONOPAD ? 1 : \
+	 (MAP) == KMIXER_SAMPLERATE_MAP_STEREO ? 2 : (int)(C)->sch)
+#define MAP_DCH(MAP, C)	\
+	((MAP) == KMIXER_SAMPLERATE_MAP_MONO || \
+	 (MAP) == KMIXER_SAMPLERATE_MAP_DOWNMIX ? 1 : \
+	 (MAP) == KMIXER_SAMPLERATE_MAP_STEREO || \
+	 (MAP) == KMIXER_SAMPLERATE_MAP_DUP ? 2 : (int)(C)->dch)
+
+#define READ_FRAME(T, BITS, EN, V, RP, SCH)	\
 	do { \
 		int j; \
-		for (j = 0; j < (FROM)->channels; j++) { \
-			(V)[j] = READ_S##BITS##EN(RP); \
+		for (j = 0; j < (SCH); j++) { \
+			(V)[j] = READ_##T##BITS##EN(RP); \
 			RP += (BITS) / NBBY; \
 		} \
 	} while (/*CONSTCOND*/ 0)
-#define P_WRITE_Sn(BITS, EN, V, WP, FROM, TO, CON, WC)	\
+
+/*
+ * MAP is a constant, so all but one arm of this is compiled away.
+ */
+#define WRITE_FRAME(T, BITS, EN, MAP, V, WP, C)	\
 	do { \
-		if ((FROM)->channels == 2 && (TO)->channels == 1) { \
-			WRITE_S##BITS##EN(WP, ((V)[0] + (V)[1]) / 2); \
+		int j; \
+		if ((MAP) == KMIXER_SAMPLERATE_MAP_DOWNMIX) { \
+			WRITE_##T##BITS##EN(WP, MEAN2(BITS, (V)[0], (V)[1])); \
+			WP += (BITS) / NBBY; \
+		} else if ((MAP) == KMIXER_SAMPLERATE_MAP_DUP || \
+			   (MAP) == KMIXER_SAMPLERATE_MAP_MONOPAD) { \
+			WRITE_##T##BITS##EN(WP, (V)[0]); \
 			WP += (BITS) / NBBY; \
-			RING_CHECK(CON, WP); \
-			WC += (BITS) / NBBY; \
-		} else { /* channels <= hw_channels */ \
-			int j; \
-			for (j = 0; j < (FROM)->channels; j++) { \
-				WRITE_S##BITS##EN(WP, (V)[j]); \
+			WRITE_##T##BITS##EN(WP, (V)[0]); \
+			WP += (BITS) / NBBY; \
+			for (j = 2; j < MAP_DCH(MAP, C); j++) { \
+				WRITE_##T##BITS##EN(WP, 0); \
 				WP += (BITS) / NBBY; \
-				RING_CHECK(CON, WP); \
 			} \
-			if (j == 1 && 1 < (TO)->channels) { \
-				WRITE_S##BITS##EN(WP, (V)[0]); \
+		} else if ((MAP) == KMIXER_SAMPLERATE_MAP_PAD) { \
+			for (j = 0; j < MAP_SCH(MAP, C); j++) { \
+				WRITE_##T##BITS##EN(WP, (V)[j]); \
 				WP += (BITS) / NBBY; \
-				RING_CHECK(CON, WP); \
-				j++; \
 			} \
-			for (; j < (TO)->channels; j++) { \
-				WRITE_S##BITS##EN(WP, 0); \
+			for (; j < MAP_DCH(MAP, C); j++) { \
+				WRITE_##T##BITS##EN(WP, 0); \
 				WP += (BITS) / NBBY; \
-				RING_CHECK(CON, WP); \
 			} \
-			WC += (BITS) / NBBY * j; \
-		} \
-	} while (/*CONSTCOND*/ 0)
-
-#define R_READ_Sn(BITS, EN, V, RP, FROM, TO, CON, RC)	\
-	do { \
-		int j; \
-		for (j = 0; j < (TO)->channels; j++) { \
-			(V)[j] = READ_S##BITS##EN(RP); \
-			RP += (BITS) / NBBY; \
-			RING_CHECK(CON, RP); \
-			RC += (BITS) / NBBY; \
-		} \
-	} while (/*CONSTCOND*/ 0)
-#define R_WRITE_Sn(BITS, EN, V, WP, FROM, TO, WC)	\
-	do { \
-		if ((FROM)->channels == 2 && (TO)->channels == 1) { \
-			WRITE_S##BITS##EN(WP, (V)[0]); \
-			WP += (BITS) / NBBY; \
-			WRITE_S##BITS##EN(WP, (V)[0]); \
-			WP += (BITS) / NBBY; \
-			WC += (BITS) / NBBY * 2; \
-		} else if ((FROM)->channels == 1 && (TO)->channels >= 2) { \
-			WRITE_S##BITS##EN(WP, ((V)[0] + (V)[1]) / 2); \
-			WP += (BITS) / NBBY; \
-			WC += (BITS) / NBBY; \
-		} else {	/* channels <= hw_channels */ \
-			int j; \
-			for (j = 0; j < (FROM)->channels; j++) { \
-				WRITE_S##BITS##EN(WP, (V)[j]); \
+		} else { \
+			for (j = 0; j < MAP_DCH(MAP, C); j++) { \
+				WRITE_##T##BITS##EN(WP, (V)[j]); \
 				WP += (BITS) / NBBY; \
 			} \
-			WC += (BITS) / NBBY * j; \
 		} \
 	} while (/*CONSTCOND*/ 0)
 
 /*
- * Function templates
+ * Function template
  *
- *   Source may be 1 sample.  Destination buffer must have space for converted
- *   source.
- *   Don't use them for 32bit data because this linear interpolation overflows
- *   for 32bit data.
+ *   One function per sample format and channel map, converting from the
+ *   context's src_rate to its dst_rate.  Source may be 1 sample.
+ *   Destination buffer must have space for converted source.  Both are
+ *   linear; kmixer_samplerate_play/record deal with the ring.
+ *   Float samples are converted as 32-bit integers.
+ *   With a polyphase filter in the context, each source frame is pushed into
+ *   the FIR history and every output frame whose phase falls before the next
+ *   source frame is computed from it.
+ *   A steered context converts even at equal rates, and advances its phase
+ *   by kmixer_samplerate_step.
  */
-#define KMIXER_SAMPLERATE_PLAY_SLINEAR(BITS, EN)	\
+#define KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, MAP)	\
 static int \
-kmixer_samplerate_play_slinear##BITS##_##EN \
+kmixer_samplerate_##NAME##BITS##_##EN##_##MAP \
 			      (struct kmixer_samplerate_context *context, \
-			       const struct audio_params *from, \
-			       const struct audio_params *to, \
 			       uint8_t *dest, const uint8_t *src, \
 			       int srcsize) \
 { \
-	int wrote; \
+	const int map = KMIXER_SAMPLERATE_MAP_##MAP; \
+	const int sch = MAP_SCH(map, context); \
+	const long src_rate = context->src_rate; \
+	const long dst_rate = context->dst_rate; \
 	uint8_t *w; \
 	const uint8_t *r; \
 	const uint8_t *src_end; \
@@ -397,115 +608,305 @@ kmixer_samplerate_play_slinear##BITS##_##EN \
 	int32_t prev[AUDIO_MAX_CHANNELS], next[AUDIO_MAX_CHANNELS], c256; \
 	int i, values_size; \
  \
-	wrote = 0; \
 	w = dest; \
 	r = src; \
 	src_end = src + srcsize; \
-	if (from->sample_rate == to->sample_rate) { \
+	if (src_rate == dst_rate && !context->steer) { \
 		while (r < src_end) { \
-			P_READ_Sn(BITS, EN, v, r, from, to); \
-			P_WRITE_Sn(BITS, EN, v, w, from, to, context, wrote); \
+			READ_FRAME(T, BITS, EN, v, r, sch); \
+			WRITE_FRAME(T, BITS, EN, map, v, w, context); \
 		} \
-	} else if (to->sample_rate < from->sample_rate) { \
+	} else if (context->filter != NULL) { \
+		while (r < src_end) { \
+			READ_FRAME(T, BITS, EN, v, r, sch); \
+			kmixer_samplerate_fir_push(context, v, sch); \
+			while (context->count < context->filter->f_up) { \
+				kmixer_samplerate_fir(context, v, sch, BITS); \
+				WRITE_FRAME(T, BITS, EN, map, v, w, context); \
+				context->count += kmixer_samplerate_step(context, \
+				    context->filter->f_down); \
+			} \
+			context->count -= context->filter->f_up; \
+		} \
+	} else if (dst_rate < src_rate) { \
 		for (;;) { \
 			do { \
 				if (r >= src_end) \
-					return wrote; \
-				P_READ_Sn(BITS, EN, v, r, from, to); \
-				context->count += to->sample_rate; \
-			} while (context->count < from->sample_rate); \
-			context->count -= from->sample_rate; \
-			P_WRITE_Sn(BITS, EN, v, w, from, to, context, wrote); \
+					return w - dest; \
+				READ_FRAME(T, BITS, EN, v, r, sch); \
+				context->count += dst_rate; \
+			} while (context->count < src_rate); \
+			context->count -= kmixer_samplerate_step(context, \
+			    src_rate); \
+			WRITE_FRAME(T, BITS, EN, map, v, w, context); \
 		} \
 	} else { \
-		/* Initial value of context->count is from->sample_rate */ \
-		values_size = sizeof(int32_t) * from->channels; \
+		/* Initial value of context->count is src_rate */ \
+		values_size = sizeof(int32_t) * sch; \
 		memcpy(prev, context->prev, values_size); \
-		P_READ_Sn(BITS, EN, next, r, from, to); \
+		READ_FRAME(T, BITS, EN, next, r, sch); \
 		for (;;) { \
-			c256 = context->count * 256 / to->sample_rate; \
-			for (i = 0; i < from->channels; i++) \
-				v[i] = (c256 * next[i] + (256 - c256) * prev[i]) >> 8; \
-			P_WRITE_Sn(BITS, EN, v, w, from, to, context, wrote); \
-			context->count += from->sample_rate; \
-			if (context->count >= to->sample_rate) { \
-				context->count -= to->sample_rate; \
+			/* a drifting step may pass next by a little */ \
+			c256 = MIN(context->count * 256 / dst_rate, 256); \
+			for (i = 0; i < sch; i++) \
+				v[i] = LERP(BITS, c256, next[i], prev[i]); \
+			WRITE_FRAME(T, BITS, EN, map, v, w, context); \
+			context->count += kmixer_samplerate_step(context, \
+			    src_rate); \
+			while (context->count >= dst_rate) { \
+				context->count -= dst_rate; \
 				memcpy(prev, next, values_size); \
 				if (r >= src_end) \
-					break; \
-				P_READ_Sn(BITS, EN, next, r, from, to); \
+					goto done; \
+				READ_FRAME(T, BITS, EN, next, r, sch); \
 			} \
 		} \
+	done: \
 		memcpy(context->prev, next, values_size); \
 	} \
-	return wrote; \
+	return w - dest; \
 }
 
-#define KMIXER_SAMPLERATE_RECORD_SLINEAR(BITS, EN)	\
-static int \
-kmixer_samplerate_record_slinear##BITS##_##EN \
-				(struct kmixer_samplerate_context *context, \
-				 const struct audio_params *from, \
-				 const struct audio_params *to, \
-				 uint8_t *dest, const uint8_t *src, \
-				 int srcsize) \
-{ \
-	int wrote, rsize; \
-	uint8_t *w; \
-	const uint8_t *r; \
-	int32_t v[AUDIO_MAX_CHANNELS]; \
-	int32_t prev[AUDIO_MAX_CHANNELS], next[AUDIO_MAX_CHANNELS], c256; \
-	int i, values_size; \
- \
-	wrote = 0; \
-	rsize = 0; \
-	w = dest; \
-	r = src; \
-	if (from->sample_rate == to->sample_rate) { \
-		while (rsize < srcsize) { \
-			R_READ_Sn(BITS, EN, v, r, from, to, context, rsize); \
-			R_WRITE_Sn(BITS, EN, v, w, from, to, wrote); \
-		} \
-	} else if (from->sample_rate < to->sample_rate) { \
-		for (;;) { \
-			do { \
-				if (rsize >= srcsize) \
-					return wrote; \
-				R_READ_Sn(BITS, EN, v, r, from, to, context, rsize); \
-				context->count += from->sample_rate; \
-			} while (context->count < to->sample_rate); \
-			context->count -= to->sample_rate; \
-			R_WRITE_Sn(BITS, EN, v, w, from, to, wrote); \
-		} \
-	} else { \
-		/* Initial value of context->count is to->sample_rate */ \
-		values_size = sizeof(int32_t) * to->channels; \
-		memcpy(prev, context->prev, values_size); \
-		R_READ_Sn(BITS, EN, next, r, from, to, context, rsize); \
-		for (;;) { \
-			c256 = context->count * 256 / from->sample_rate; \
-			for (i = 0; i < to->channels; i++) \
-				v[i] = (c256 * next[i] + (256 - c256) * prev[i]) >> 8; \
-			R_WRITE_Sn(BITS, EN, v, w, from, to, wrote); \
-			context->count += to->sample_rate; \
-			if (context->count >= from->sample_rate) { \
-				context->count -= from->sample_rate; \
-				memcpy(prev, next, values_size); \
-				if (rsize >= srcsize) \
-					break; \
-				R_READ_Sn(BITS, EN, next, r, from, to, context, rsize); \
-			} \
-		} \
-		memcpy(context->prev, next, values_size); \
-	} \
-	return wrote; \
+#define KMIXER_SAMPLERATE_KERNELS(NAME, T, BITS, EN)	\
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, MONO) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, STEREO) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, COPY) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, DUP) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, MONOPAD) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, PAD) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, DOWNMIX) \
+	KMIXER_SAMPLERATE_KERNEL(NAME, T, BITS, EN, DROP)
+
+#define KMIXER_SAMPLERATE_TABLE(NAME, BITS, EN)	\
+	{ \
+		kmixer_samplerate_##NAME##BITS##_##EN##_MONO, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_STEREO, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_COPY, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_DUP, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_MONOPAD, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_PAD, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_DOWNMIX, \
+		kmixer_samplerate_##NAME##BITS##_##EN##_DROP, \
+	}
+
+KMIXER_SAMPLERATE_KERNELS(slinear, S, 16, LE)
+KMIXER_SAMPLERATE_KERNELS(slinear, S, 24, LE)
+KMIXER_SAMPLERATE_KERNELS(slinear, S, 32, LE)
+KMIXER_SAMPLERATE_KERNELS(slinear, S, 16, BE)
+KMIXER_SAMPLERATE_KERNELS(slinear, S, 24, BE)
+KMIXER_SAMPLERATE_KERNELS(slinear, S, 32, BE)
+KMIXER_SAMPLERATE_KERNELS(float, F, 32, LE)
+KMIXER_SAMPLERATE_KERNELS(float, F, 32, BE)
+
+static const struct {
+	u_int	encoding;
+	u_int	precision;
+	kmixer_samplerate_kernel_t *kernel[KMIXER_SAMPLERATE_NMAPS];
+} kmixer_samplerate_kernels[] = {
+	{ AUDIO_ENCODING_SLINEAR_LE, 16,
+	  KMIXER_SAMPLERATE_TABLE(slinear, 16, LE) },
+	{ AUDIO_ENCODING_SLINEAR_LE, 24,
+	  KMIXER_SAMPLERATE_TABLE(slinear, 24, LE) },
+	{ AUDIO_ENCODING_SLINEAR_LE, 32,
+	  KMIXER_SAMPLERATE_TABLE(slinear, 32, LE) },
+	{ AUDIO_ENCODING_SLINEAR_BE, 16,
+	  KMIXER_SAMPLERATE_TABLE(slinear, 16, BE) },
+	{ AUDIO_ENCODING_SLINEAR_BE, 24,
+	  KMIXER_SAMPLERATE_TABLE(slinear, 24, BE) },
+	{ AUDIO_ENCODING_SLINEAR_BE, 32,
+	  KMIXER_SAMPLERATE_TABLE(slinear, 32, BE) },
+	{ KMIXER_ENCODING_FLOAT_LE, 32,
+	  KMIXER_SAMPLERATE_TABLE(float, 32, LE) },
+	{ KMIXER_ENCODING_FLOAT_BE, 32,
+	  KMIXER_SAMPLERATE_TABLE(float, 32, BE) },
+};
+
+/*
+ * Same rate, same channels: nothing to convert.
+ */
+static int
+kmixer_samplerate_copy(struct kmixer_samplerate_context *context,
+    uint8_t *dest, const uint8_t *src, int srcsize)
+{
+	memcpy(dest, src, srcsize);
+	return srcsize;
+}
+
+/*
+ * Native-endian 16-bit mono to stereo and stereo to mono at equal rates
+ * go through the vector kernels.  Only record groups convert to such a
+ * format; play groups convert on the 32-bit mix bus.
+ */
+static int
+kmixer_samplerate_dup_s16(struct kmixer_samplerate_context *context,
+    uint8_t *dest, const uint8_t *src, int srcsize)
+{
+	kmixer_simd_dup_s16((int16_t *)dest, (const int16_t *)src,
+	    srcsize / sizeof(int16_t));
+	return srcsize * 2;
+}
+
+static int
+kmixer_samplerate_downmix_s16(struct kmixer_samplerate_context *context,
+    uint8_t *dest, const uint8_t *src, int srcsize)
+{
+	kmixer_simd_downmix_s16((int16_t *)dest, (const int16_t *)src,
+	    srcsize / (2 * sizeof(int16_t)));
+	return srcsize / 2;
 }
 
-KMIXER_SAMPLERATE_PLAY_SLINEAR(16, LE)
-KMIXER_SAMPLERATE_PLAY_SLINEAR(24, LE)
-KMIXER_SAMPLERATE_PLAY_SLINEAR(16, BE)
-KMIXER_SAMPLERATE_PLAY_SLINEAR(24, BE)
-KMIXER_SAMPLERATE_RECORD_SLINEAR(16, LE)
-KMIXER_SAMPLERATE_RECORD_SLINEAR(24, LE)
-KMIXER_SAMPLERATE_RECORD_SLINEAR(16, BE)
-KMIXER_SAMPLERATE_RECORD_SLINEAR(24, BE)
+/*
+ * Pick the kernel for converting src to dst.  The formats are assumed to
+ * have passed kmixer_samplerate_check_params.
+ */
+static int
+kmixer_samplerate_select(struct kmixer_samplerate_context *context,
+    const struct audio_params *src, const struct audio_params *dst)
+{
+	u_int i, map;
+
+	if (src->sample_rate == dst->sample_rate &&
+	    src->channels == dst->channels && !context->steer) {
+		context->kernel = kmixer_samplerate_copy;
+		return 0;
+	}
+
+	if (src->channels == dst->channels)
+		map = src->channels == 1 ? KMIXER_SAMPLERATE_MAP_MONO :
+		    src->channels == 2 ? KMIXER_SAMPLERATE_MAP_STEREO :
+		    KMIXER_SAMPLERATE_MAP_COPY;
+	else if (src->channels == 1)
+		map = dst->channels == 2 ? KMIXER_SAMPLERATE_MAP_DUP :
+		    KMIXER_SAMPLERATE_MAP_MONOPAD;
+	else if (dst->channels == 1)
+		map = KMIXER_SAMPLERATE_MAP_DOWNMIX;
+	else if (src->channels < dst->channels)
+		map = KMIXER_SAMPLERATE_MAP_PAD;
+	else
+		map = KMIXER_SAMPLERATE_MAP_DROP;
+
+	if (src->sample_rate == dst->sample_rate && !context->steer &&
+	    dst->precision == 16 &&
+	    dst->encoding == AUDIO_ENCODING_SLINEAR_NE) {
+		if (map == KMIXER_SAMPLERATE_MAP_DUP) {
+			context->kernel = kmixer_samplerate_dup_s16;
+			return 0;
+		}
+		if (map == KMIXER_SAMPLERATE_MAP_DOWNMIX &&
+		    src->channels == 2) {
+			context->kernel = kmixer_samplerate_downmix_s16;
+			return 0;
+		}
+	}
+
+	for (i = 0; i < __arraycount(kmixer_samplerate_kernels); i++) {
+		if (kmixer_samplerate_kernels[i].encoding == dst->encoding &&
+		    kmixer_samplerate_kernels[i].precision == dst->precision) {
+			context->kernel = kmixer_samplerate_kernels[i].kernel[map];
+			return 0;
+		}
+	}
+
+	/* This should be rejected in kmixer_samplerate_check_params */
+	printf("kmixer_samplerate: unimplemented format: enc %d prec %d\n",
+	       dst->encoding, dst->precision);
+	context->kernel = NULL;
+	return EINVAL;
+}
+
+/*
+ * src is a ring buffer.  The run up to ring_end and the run from
+ * ring_start are each converted as a linear buffer; a frame split by the
+ * wrap is gathered into a bounce frame first.
+ */
+int
+kmixer_samplerate_record(struct kmixer_samplerate_context *context,
+    uint8_t *dest, const uint8_t *src, int srcsize)
+{
+	int32_t frame[AUDIO_MAX_CHANNELS];
+	const int fsize = context->sfsize;
+	int n, part, wrote;
+
+	n = context->ring_end - src;
+	if (srcsize <= n) {
+		if (srcsize == 0)
+			return 0;
+		return (*context->kernel)(context, dest, src, srcsize);
+	}
+
+	wrote = 0;
+	part = n % fsize;
+	if (n > part) {
+		wrote = (*context->kernel)(context, dest, src, n - part);
+		srcsize -= n - part;
+	}
+	src = context->ring_start;
+	if (part != 0) {
+		memcpy(frame, context->ring_end - part, part);
+		memcpy((uint8_t *)frame + part, src, fsize - part);
+		wrote += (*context->kernel)(context, dest + wrote,
+		    (uint8_t *)frame, fsize);
+		src += fsize - part;
+		srcsize -= fsize;
+	}
+	if (srcsize > 0)
+		wrote += (*context->kernel)(context, dest + wrote, src,
+		    srcsize);
+	return wrote;
+}
+
+/*
+ * dest is a ring buffer.  Source frames whose output surely fits before
+ * ring_end are converted straight into the ring, the few around the wrap
+ * go one at a time through the context's bounce buffer, and the rest are
+ * converted straight to ring_start.
+ */
+int
+kmixer_samplerate_play(struct kmixer_samplerate_context *context,
+    uint8_t *dest, const uint8_t *src, int srcsize)
+{
+	const int isize = context->sfsize;
+	u_int nframes, room, n, o;
+	int wrote;
+
+	nframes = srcsize / isize;
+	if (nframes == 0)
+		return 0;
+	room = (context->ring_end - dest) / context->dfsize;
+	if (kmixer_samplerate_maxout(context->src_rate, context->dst_rate,
+	    nframes) <= room)
+		return (*context->kernel)(context, dest, src, srcsize);
+
+	wrote = 0;
+	if (room > 3) {
+		/* as kmixer_samplerate_maxout, the other way round */
+		n = room - 3 - (room >> KMIXER_SAMPLERATE_DRIFTSHIFT);
+		n = (uint64_t)n * context->src_rate / context->dst_rate;
+		n = MIN(n, nframes);
+		if (n > 0) {
+			wrote = (*context->kernel)(context, dest, src,
+			    n * isize);
+			dest += wrote;
+			src += n * isize;
+			nframes -= n;
+		}
+	}
+	while (nframes > 0) {
+		o = (*context->kernel)(context, context->bounce, src, isize);
+		src += isize;
+		nframes--;
+		wrote += o;
+		n = MIN(o, (u_int)(context->ring_end - dest));
+		memcpy(dest, context->bounce, n);
+		dest += n;
+		if (n < o || dest == context->ring_end) {
+			memcpy(context->ring_start, context->bounce + n, o - n);
+			dest = context->ring_start + o - n;
+			break;
+		}
+	}
+	if (nframes > 0)
+		wrote += (*context->kernel)(context, dest, src,
+		    nframes * isize);
+	return wrote;
+}
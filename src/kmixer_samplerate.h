@@ -41,24 +41,78 @@
 
 #include <dev/audio_if.h>
 
+/* converter quality */
+#define KMIXER_SAMPLERATE_LINEAR	0	/* linear interpolation */
+#define KMIXER_SAMPLERATE_SHORT		1	/* short windowed-sinc FIR */
+#define KMIXER_SAMPLERATE_LONG		2	/* long windowed-sinc FIR */
+
+/*
+ * A steered context stretches its rate ratio by up to 2^-DRIFTSHIFT
+ * either way, see kmixer_samplerate_set_drift.
+ */
+#define KMIXER_SAMPLERATE_DRIFTSHIFT	10
+#define KMIXER_SAMPLERATE_MAXDRIFT	(1 << (32 - KMIXER_SAMPLERATE_DRIFTSHIFT))
+
+struct kmixer_samplerate_filter;
+struct kmixer_samplerate_context;
+
+/* converts srcsize bytes between linear buffers, returns bytes written */
+typedef int kmixer_samplerate_kernel_t(struct kmixer_samplerate_context *,
+				       uint8_t *, const uint8_t *, int);
+
 struct kmixer_samplerate_context {
+	/* chosen from the formats by kmixer_samplerate_init_context */
+	kmixer_samplerate_kernel_t *kernel;
+	long	src_rate;
+	long	dst_rate;
+	u_int	sch;		/* source and destination channels */
+	u_int	dch;
+	u_int	sfsize;		/* source and destination frame size */
+	u_int	dfsize;
+
 	long	count;
+	bool	steer;		/* converts even at equal rates */
+	int32_t	drift;		/* ratio stretch, Q32 */
+	uint32_t dfrac;		/* carry of drift, Q32 of a count step */
 	int32_t	prev[AUDIO_MAX_CHANNELS];
 	uint8_t	*ring_start;
 	uint8_t	*ring_end;
+	uint8_t	*bounce;	/* output of one frame across ring_end */
+	size_t	bouncesize;
+
+	/* polyphase FIR state, filter is NULL for linear interpolation */
+	struct kmixer_samplerate_filter *filter;
+	int32_t	*hist;		/* 2 * ntaps samples per channel */
+	size_t	histsize;
+	u_int	hpos;
 };
 
+/*
+ * Upper bound on the frames converting nframes source frames produces,
+ * whatever the state and drift of the context.
+ */
+static inline u_int
+kmixer_samplerate_maxout(long src_rate, long dst_rate, u_int nframes)
+{
+	uint64_t n = (uint64_t)nframes * dst_rate / src_rate;
+
+	return n + (n >> KMIXER_SAMPLERATE_DRIFTSHIFT) + 3;
+}
+
+void kmixer_samplerate_init(void);
+void kmixer_samplerate_fini(void);
 int kmixer_samplerate_check_params(const struct audio_params *,
 				   const struct audio_params *);
-void kmixer_samplerate_init_context(struct kmixer_samplerate_context *,
-				    long, long, uint8_t *, uint8_t *);
+int kmixer_samplerate_init_context(struct kmixer_samplerate_context *,
+				   const struct audio_params *,
+				   const struct audio_params *, int, bool,
+				   uint8_t *, uint8_t *);
+void kmixer_samplerate_set_drift(struct kmixer_samplerate_context *,
+				 int32_t);
+void kmixer_samplerate_destroy_context(struct kmixer_samplerate_context *);
 int kmixer_samplerate_play(struct kmixer_samplerate_context *,
-			   const struct audio_params *,
-			   const struct audio_params *,
 			   uint8_t *, const uint8_t *, int);
 int kmixer_samplerate_record(struct kmixer_samplerate_context *,
-			     const struct audio_params *,
-			     const struct audio_params *,
 			     uint8_t *, const uint8_t *, int);
 
 #endif /* _KMIXER_SAMPLERATE_H */
@@ -0,0 +1,873 @@
+/* $NetBSD$ */
+
+/*
+ * Generated by bench/kmixer_gensinc.c, do not edit.
+ * Kaiser-windowed sinc, 128 points per zero crossing, Q30.
+ */
+
+#define KMIXER_SINC_OVERSAMPLE	128
+#define KMIXER_SINC_ONE		(1 << 30)
+
+#define KMIXER_SINC_SHORT_ZEROS	8
+
+static const int32_t kmixer_sinc_short[1024 + 1] = {
+	1073741824, 1073631222, 1073299460, 1072746664, 1071973045, 1070978901,
+	1069764612, 1068330643, 1066677544, 1064805946, 1062716566, 1060410204,
+	1057887742, 1055150145, 1052198458, 1049033811, 1045657410, 1042070546,
+	1038274588, 1034270982, 1030061255, 1025647012, 1021029933, 1016211774,
+	1011194368, 1005979621, 1000569515, 994966101, 989171504, 983187919,
+	977017612, 970662915, 964126230, 957410024, 950516829, 943449242,
+	936209923, 928801593, 921227033, 913489083, 905590643, 897534667,
+	889324164, 880962198, 872451885, 863796391, 854998932, 846062771,
+	836991218, 827787628, 818455399, 808997971, 799418824, 789721477,
+	779909483, 769986436, 759955958, 749821706, 739587367, 729256657,
+	718833318, 708321118, 697723849, 687045323, 676289374, 665459854,
+	654560632, 643595591, 632568628, 621483652, 610344581, 599155340,
+	587919863, 576642085, 565325947, 553975390, 542594352, 531186773,
+	519756585, 508307715, 496844084, 485369602, 473888168, 462403670,
+	450919980, 439440954, 427970430, 416512229, 405070149, 393647965,
+	382249428, 370878265, 359538174, 348232825, 336965855, 325740874,
+	314561454, 303431133, 292353415, 281331764, 270369604, 259470322,
+	248637259, 237873715, 227182945, 216568158, 206032515, 195579130,
+	185211067, 174931338, 164742905, 154648675, 144651503, 134754186,
+	124959467, 115270032, 105688506, 96217458, 86859395, 77616764,
+	68491950, 59487274, 50604996, 41847309, 33216345, 24714168,
+	16342774, 8104097, 0, -7967721, -15797338, -23487192,
+	-31035693, -38441321, -45702627, -52818230, -59786821, -66607162,
+	-73278087, -79798499, -86167374, -92383759, -98446773, -104355607,
+	-110109522, -115707852, -121150003, -126435451, -131563745, -136534503,
+	-141347416, -146002244, -150498819, -154837042, -159016884, -163038386,
+	-166901657, -170606876, -174154288, -177544207, -180777014, -183853156,
+	-186773147, -189537564, -192147051, -194602314, -196904124, -199053313,
+	-201050776, -202897466, -204594401, -206142653, -207543356, -208797700,
+	-209906932, -210872353, -211695322, -212377247, -212919594, -213323875,
+	-213591656, -213724552, -213724226, -213592387, -213330792, -212941243,
+	-212425583, -211785701, -211023524, -210141023, -209140205, -208023116,
+	-206791837, -205448486, -203995214, -202434204, -200767672, -198997864,
+	-197127051, -195157537, -193091647, -190931734, -188680173, -186339362,
+	-183911718, -181399679, -178805700, -176132254, -173381827, -170556922,
+	-167660051, -164693740, -161660524, -158562947, -155403559, -152184918,
+	-148909583, -145580120, -142199095, -138769075, -135292625, -131772311,
+	-128210692, -124610326, -120973762, -117303543, -113602206, -109872274,
+	-106116262, -102336674, -98535998, -94716709, -90881266, -87032113,
+	-83171673, -79302354, -75426540, -71546596, -67664866, -63783668,
+	-59905297, -56032024, -52166091, -48309716, -44465087, -40634362,
+	-36819672, -33023115, -29246757, -25492633, -21762743, -18059055,
+	-14383501, -10737977, -7124343, -3544422, 0, 3507177,
+	6975399, 10403000, 13788349, 17129859, 20425983, 23675215,
+	26876093, 30027196, 33127146, 36174608, 39168292, 42106951,
+	44989381, 47814425, 50580969, 53287945, 55934330, 58519146,
+	61041461, 63500388, 65895086, 68224761, 70488662, 72686086,
+	74816376, 76878920, 78873151, 80798550, 82654641, 84440994,
+	86157225, 87802995, 89378010, 90882019, 92314817, 93676242,
+	94966177, 96184547, 97331322, 98406512, 99410171, 100342396,
+	101203323, 101993132, 102712040, 103360306, 103938230, 104446149,
+	104884439, 105253514, 105553826, 105785862, 105950147, 106047241,
+	106077739, 106042269, 105941494, 105776110, 105546844, 105254455,
+	104899733, 104483497, 104006597, 103469909, 102874339, 102220819,
+	101510307, 100743787, 99922266, 99046776, 98118372, 97138131,
+	96107150, 95026548, 93897462, 92721049, 91498484, 90230957,
+	88919677, 87565865, 86170758, 84735608, 83261678, 81750243,
+	80202587, 78620009, 77003812, 75355310, 73675825, 71966683,
+	70229217, 68464767, 66674675, 64860285, 63022945, 61164005,
+	59284815, 57386724, 55471082, 53539235, 51592529, 49632304,
+	47659898, 45676643, 43683865, 41682885, 39675016, 37661563,
+	35643822, 33623081, 31600617, 29577696, 27555574, 25535493,
+	23518684, 21506364, 19499735, 17499987, 15508293, 13525809,
+	11553678, 9593023, 7644952, 5710553, 3790897, 1887035,
+	0, -1869196, -3719562, -5550125, -7359937, -9148068,
+	-10913612, -12655685, -14373426, -16065995, -17732578, -19372383,
+	-20984641, -22568611, -24123571, -25648827, -27143710, -28607575,
+	-30039802, -31439796, -32806989, -34140838, -35440824, -36706457,
+	-37937271, -39132825, -40292706, -41416526, -42503923, -43554562,
+	-44568132, -45544350, -46482957, -47383722, -48246438, -49070925,
+	-49857027, -50604615, -51313583, -51983853, -52615370, -53208103,
+	-53762049, -54277225, -54753675, -55191466, -55590687, -55951454,
+	-56273903, -56558193, -56804507, -57013049, -57184043, -57317739,
+	-57414404, -57474328, -57497821, -57485211, -57436848, -57353101,
+	-57234357, -57081021, -56893518, -56672288, -56417791, -56130500,
+	-55810907, -55459519, -55076859, -54663463, -54219883, -53746685,
+	-53244446, -52713760, -52155230, -51569471, -50957113, -50318792,
+	-49655158, -48966869, -48254594, -47519010, -46760802, -45980663,
+	-45179295, -44357405, -43515706, -42654918, -41775767, -40878982,
+	-39965298, -39035452, -38090186, -37130244, -36156372, -35169318,
+	-34169832, -33158664, -32136565, -31104284, -30062573, -29012179,
+	-27953850, -26888330, -25816363, -24738689, -23656042, -22569156,
+	-21478759, -20385575, -19290321, -18193711, -17096452, -15999244,
+	-14902781, -13807750, -12714830, -11624693, -10538001, -9455411,
+	-8377566, -7305105, -6238654, -5178831, -4126242, -3081484,
+	-2045143, -1017794, 0, 1007687, 2004726, 2990589,
+	3964761, 4926738, 5876029, 6812157, 7734656, 8643075,
+	9536976, 10415934, 11279538, 12127392, 12959112, 13774330,
+	14572690, 15353852, 16117491, 16863293, 17590963, 18300218,
+	18990790, 19662425, 20314885, 20947947, 21561400, 22155050,
+	22728717, 23282237, 23815458, 24328245, 24820476, 25292044,
+	25742856, 26172835, 26581915, 26970048, 27337196, 27683339,
+	28008467, 28312587, 28595717, 28857890, 29099151, 29319559,
+	29519186, 29698116, 29856446, 29994285, 30111754, 30208988,
+	30286131, 30343341, 30380785, 30398642, 30397103, 30376370,
+	30336652, 30278172, 30201161, 30105860, 29992521, 29861402,
+	29712772, 29546909, 29364099, 29164636, 28948821, 28716963,
+	28469380, 28206394, 27928337, 27635545, 27328361, 27007134,
+	26672217, 26323972, 25962763, 25588958, 25202933, 24805064,
+	24395734, 23975327, 23544233, 23102843, 22651551, 22190754,
+	21720850, 21242241, 20755327, 20260512, 19758201, 19248798,
+	18732708, 18210338, 17682092, 17148375, 16609592, 16066146,
+	15518439, 14966871, 14411842, 13853749, 13292986, 12729947,
+	12165020, 11598592, 11031048, 10462767, 9894127, 9325500,
+	8757256, 8189759, 7623370, 7058444, 6495333, 5934382,
+	5375933, 4820321, 4267876, 3718922, 3173778, 2632758,
+	2096166, 1564304, 1037465, 515937, 0, -510072,
+	-1014011, -1511558, -2002461, -2486472, -2963353, -3432875,
+	-3894812, -4348948, -4795076, -5232993, -5662507, -6083433,
+	-6495591, -6898813, -7292936, -7677807, -8053278, -8419211,
+	-8775475, -9121949, -9458516, -9785071, -10101515, -10407756,
+	-10703711, -10989305, -11264470, -11529146, -11783282, -12026832,
+	-12259760, -12482036, -12693638, -12894552, -13084772, -13264296,
+	-13433132, -13591295, -13738806, -13875693, -14001991, -14117743,
+	-14222997, -14317807, -14402236, -14476350, -14540225, -14593939,
+	-14637578, -14671234, -14695005, -14708993, -14713306, -14708059,
+	-14693369, -14669361, -14636162, -14593907, -14542732, -14482781,
+	-14414199, -14337137, -14251751, -14158197, -14056639, -13947242,
+	-13830175, -13705609, -13573721, -13434688, -13288691, -13135914,
+	-12976542, -12810763, -12638767, -12460747, -12276897, -12087411,
+	-11892488, -11692325, -11487122, -11277079, -11062399, -10843282,
+	-10619932, -10392552, -10161345, -9926514, -9688265, -9446798,
+	-9202319, -8955028, -8705129, -8452823, -8198309, -7941789,
+	-7683460, -7423519, -7162162, -6899583, -6635976, -6371532,
+	-6106439, -5840886, -5575056, -5309134, -5043301, -4777735,
+	-4512611, -4248105, -3984385, -3721622, -3459980, -3199621,
+	-2940706, -2683390, -2427828, -2174168, -1922559, -1673144,
+	-1426062, -1181452, -939445, -700173, -463760, -230329,
+	0, 227113, 450898, 671248, 888060, 1101232,
+	1310670, 1516281, 1717976, 1915673, 2109289, 2298749,
+	2483981, 2664916, 2841488, 3013639, 3181310, 3344449,
+	3503007, 3656940, 3806206, 3950767, 4090591, 4225648,
+	4355912, 4481361, 4601977, 4717745, 4828654, 4934696,
+	5035868, 5132170, 5223605, 5310179, 5391902, 5468788,
+	5540853, 5608118, 5670604, 5728338, 5781350, 5829671,
+	5873337, 5912385, 5946855, 5976793, 6002242, 6023253,
+	6039876, 6052164, 6060174, 6063965, 6063595, 6059129,
+	6050631, 6038167, 6021806, 6001619, 5977678, 5950056,
+	5918830, 5884075, 5845872, 5804299, 5759438, 5711371,
+	5660182, 5605956, 5548777, 5488733, 5425910, 5360398,
+	5292284, 5221658, 5148609, 5073229, 4995607, 4915836,
+	4834005, 4750207, 4664532, 4577073, 4487920, 4397166,
+	4304900, 4211214, 4116199, 4019945, 3922541, 3824076,
+	3724639, 3624318, 3523201, 3421373, 3318921, 3215930,
+	3112482, 3008662, 2904552, 2800231, 2695781, 2591280,
+	2486805, 2382432, 2278237, 2174292, 2070672, 1967445,
+	1864682, 1762451, 1660819, 1559849, 1459607, 1360153,
+	1261548, 1163850, 1067118, 971405, 876766, 783252,
+	690914, 599801, 509959, 421433, 334267, 248501,
+	164177, 81331, 0, -79782, -157981, -234568,
+	-309513, -382789, -454370, -524233, -592355, -658717,
+	-723299, -786086, -847061, -906212, -963527, -1018995,
+	-1072609, -1124361, -1174246, -1222261, -1268404, -1312674,
+	-1355072, -1395600, -1434263, -1471066, -1506015, -1539120,
+	-1570388, -1599832, -1627464, -1653296, -1677344, -1699623,
+	-1720150, -1738944, -1756023, -1771408, -1785121, -1797183,
+	-1807618, -1816450, -1823705, -1829407, -1833585, -1836265,
+	-1837476, -1837247, -1835608, -1832588, -1828219, -1822533,
+	-1815561, -1807336, -1797891, -1787260, -1775475, -1762572,
+	-1748584, -1733548, -1717496, -1700465, -1682491, -1663608,
+	-1643852, -1623259, -1601865, -1579705, -1556816, -1533232,
+	-1508990, -1484125, -1458672, -1432667, -1406145, -1379139,
+	-1351686, -1323819, -1295572, -1266979, -1238073, -1208886,
+	-1179452, -1149803, -1119969, -1089983, -1059875, -1029675,
+	-999412, -969117, -938817, -908540, -878314, -848165,
+	-818121, -788206, -758445, -728862, -699482, -670326,
+	-641418, -612778, -584428, -556388, -528677, -501313,
+	-474315, -447701, -421485, -395685, -370316, -345391,
+	-320924, -296928, -273415, -250396, -227883, -205884,
+	-184410, -163468, -143066, -123212, -103912, -85170,
+	-66993, -49384, -32347, -15885, 0,
+};
+
+#define KMIXER_SINC_LONG_ZEROS	32
+
+static const int32_t kmixer_sinc_long[4096 + 1] = {
+	1073741824, 1073633753, 1073309581, 1072769424, 1072013480, 1071042022,
+	1069855405, 1068454059, 1066838494, 1065009296, 1062967130, 1060712737,
+	1058246937, 1055570624, 1052684768, 1049590418, 1046288696, 1042780797,
+	1039067993, 1035151630, 1031033125, 1026713968, 1022195722, 1017480021,
+	1012568568, 1007463138, 1002165572, 996677782, 991001746, 985139509,
+	979093180, 972864936, 966457015, 959871718, 953111409, 946178512,
+	939075511, 931804949, 924369425, 916771597, 909014175, 901099927,
+	893031672, 884812279, 876444671, 867931818, 859276738, 850482497,
+	841552206, 832489019, 823296133, 813976788, 804534262, 794971873,
+	785292974, 775500957, 765599246, 755591297, 745480601, 735270674,
+	724965065, 714567348, 704081121, 693510007, 682857653, 672127725,
+	661323908, 650449906, 639509437, 628506237, 617444051, 606326640,
+	595157771, 583941221, 572680774, 561380218, 550043347, 538673954,
+	527275834, 515852782, 504408589, 492947040, 481471919, 469986998,
+	458496043, 447002809, 435511037, 424024458, 412546786, 401081718,
+	389632935, 378204096, 366798842, 355420790, 344073532, 332760637,
+	321485647, 310252074, 299063402, 287923085, 276834543, 265801164,
+	254826300, 243913267, 233065344, 222285772, 211577750, 200944437,
+	190388950, 179914363, 169523702, 159219952, 149006047, 138884876,
+	128859275, 118932034, 109105890, 99383527, 89767577, 80260618,
+	70865173, 61583708, 52418633, 43372301, 34447007, 25644985,
+	16968410, 8419397, 0, -8287791, -16442045, -24460899,
+	-32342549, -40085259, -47687354, -55147228, -62463339, -69634210,
+	-76658432, -83534663, -90261627, -96838117, -103262991, -109535178,
+	-115653674, -121617543, -127425917, -133077997, -138573054, -143910424,
+	-149089516, -154109805, -158970835, -163672218, -168213636, -172594838,
+	-176815640, -180875927, -184775653, -188514837, -192093566, -195511993,
+	-198770339, -201868888, -204807992, -207588067, -210209594, -212673118,
+	-214979248, -217128654, -219122070, -220960293, -222644178, -224174643,
+	-225552664, -226779278, -227855579, -228782719, -229561906, -230194406,
+	-230681537, -231024673, -231225242, -231284724, -231204649, -230986601,
+	-230632209, -230143155, -229521167, -228768018, -227885529, -226875564,
+	-225740031, -224480881, -223100105, -221599735, -219981842, -218248534,
+	-216401956, -214444290, -212377750, -210204584, -207927073, -205547528,
+	-203068288, -200491722, -197820226, -195056220, -192202150, -189260485,
+	-186233716, -183124353, -179934928, -176667988, -173326100, -169911845,
+	-166427816, -162876622, -159260883, -155583229, -151846297, -148052734,
+	-144205193, -140306332, -136358812, -132365297, -128328453, -124250945,
+	-120135437, -115984590, -111801061, -107587503, -103346562, -99080877,
+	-94793076, -90485780, -86161597, -81823122, -77472939, -73113615,
+	-68747701, -64377731, -60006223, -55635673, -51268558, -46907332,
+	-42554429, -38212256, -33883197, -29569612, -25273832, -20998160,
+	-16744872, -12516212, -8314397, -4141609, 0, 4108313,
+	8181246, 12216751, 16212814, 20167459, 24078748, 27944778,
+	31763688, 35533655, 39252896, 42919670, 46532276, 50089056,
+	53588395, 57028719, 60408501, 63726255, 66980542, 70169967,
+	73293182, 76348883, 79335814, 82252765, 85098573, 87872123,
+	90572347, 93198227, 95748789, 98223112, 100620320, 102939589,
+	105180140, 107341246, 109422229, 111422457, 113341351, 115178378,
+	116933057, 118604953, 120193682, 121698908, 123120344, 124457753,
+	125710943, 126879774, 127964152, 128964030, 129879410, 130710341,
+	131456919, 132119286, 132697630, 133192185, 133603232, 133931095,
+	134176142, 134338788, 134419490, 134418746, 134337100, 134175136,
+	133933480, 133612799, 133213800, 132737230, 132183875, 131554557,
+	130850140, 130071522, 129219637, 128295457, 127299986, 126234264,
+	125099363, 123896388, 122626477, 121290796, 119890545, 118426949,
+	116901264, 115314774, 113668788, 111964641, 110203695, 108387333,
+	106516964, 104594017, 102619943, 100596215, 98524323, 96405777,
+	94242104, 92034849, 89785571, 87495844, 85167257, 82801411,
+	80399919, 77964404, 75496501, 72997852, 70470108, 67914928,
+	65333975, 62728918, 60101432, 57453192, 54785877, 52101168,
+	49400746, 46686290, 43959479, 41221989, 38475494, 35721661,
+	32962153, 30198629, 27432739, 24666125, 21900420, 19137249,
+	16378225, 13624950, 10879015, 8141997, 5415459, 2700948,
+	0, -2685870, -5355161, -8006392, -10638098, -13248835,
+	-15837178, -18401724, -20941089, -23453913, -25938859, -28394610,
+	-30819877, -33213393, -35573916, -37900232, -40191151, -42445511,
+	-44662176, -46840038, -48978020, -51075071, -53130169, -55142323,
+	-57110571, -59033984, -60911661, -62742732, -64526362, -66261743,
+	-67948104, -69584703, -71170832, -72705815, -74189012, -75619813,
+	-76997643, -78321961, -79592259, -80808064, -81968937, -83074471,
+	-84124297, -85118076, -86055508, -86936324, -87760290, -88527206,
+	-89236908, -89889263, -90484176, -91021583, -91501455, -91923796,
+	-92288643, -92596070, -92846179, -93039108, -93175027, -93254139,
+	-93276679, -93242912, -93153138, -93007685, -92806913, -92551214,
+	-92241009, -91876749, -91458913, -90988011, -90464582, -89889191,
+	-89262432, -88584926, -87857320, -87080289, -86254532, -85380774,
+	-84459764, -83492276, -82479108, -81421079, -80319032, -79173832,
+	-77986363, -76757534, -75488268, -74179514, -72832234, -71447411,
+	-70026046, -68569155, -67077771, -65552942, -63995732, -62407217,
+	-60788489, -59140651, -57464818, -55762117, -54033686, -52280671,
+	-50504230, -48705527, -46885736, -45046035, -43187612, -41311658,
+	-39419370, -37511949, -35590600, -33656530, -31710949, -29755066,
+	-27790094, -25817243, -23837725, -21852748, -19863520, -17871244,
+	-15877121, -13882347, -11888114, -9895607, -7906006, -5920484,
+	-3940206, -1966329, 0, 1957641, 3905466, 5842357,
+	7767208, 9678924, 11576422, 13458635, 15324506, 17172994,
+	19003073, 20813732, 22603975, 24372823, 26119315, 27842505,
+	29541465, 31215288, 32863084, 34483980, 36077127, 37641692,
+	39176864, 40681854, 42155892, 43598232, 45008146, 46384933,
+	47727911, 49036423, 50309833, 51547529, 52748926, 53913457,
+	55040584, 56129792, 57180589, 58192510, 59165113, 60097983,
+	60990728, 61842984, 62654409, 63424691, 64153540, 64840693,
+	65485913, 66088988, 66649732, 67167986, 67643615, 68076512,
+	68466593, 68813803, 69118108, 69379505, 69598012, 69773674,
+	69906562, 69996772, 70044422, 70049659, 70012651, 69933592,
+	69812701, 69650219, 69446412, 69201568, 68916000, 68590043,
+	68224054, 67818413, 67373523, 66889807, 66367709, 65807696,
+	65210255, 64575891, 63905133, 63198525, 62456635, 61680044,
+	60869357, 60025192, 59148189, 58239001, 57298299, 56326771,
+	55325120, 54294063, 53234334, 52146678, 51031857, 49890644,
+	48723826, 47532200, 46316577, 45077779, 43816636, 42533991,
+	41230695, 39907608, 38565600, 37205547, 35828332, 34434848,
+	33025990, 31602662, 30165771, 28716230, 27254956, 25782869,
+	24300891, 22809948, 21310967, 19804876, 18292604, 16775081,
+	15253236, 13727995, 12200286, 10671034, 9141158, 7611580,
+	6083212, 4556967, 3033750, 1514463, 0, -1508749,
+	-3010903, -4505585, -5991929, -7469076, -8936175, -10392384,
+	-11836873, -13268819, -14687412, -16091851, -17481347, -18855125,
+	-20212418, -21552475, -22874557, -24177938, -25461907, -26725766,
+	-27968832, -29190437, -30389929, -31566669, -32720036, -33849426,
+	-34954249, -36033934, -37087925, -38115686, -39116696, -40090454,
+	-41036475, -41954293, -42843462, -43703553, -44534156, -45334881,
+	-46105356, -46845230, -47554170, -48231864, -48878018, -49492359,
+	-50074634, -50624610, -51142074, -51626833, -52078714, -52497565,
+	-52883254, -53235669, -53554717, -53840328, -54092450, -54311053,
+	-54496125, -54647675, -54765732, -54850346, -54901584, -54919536,
+	-54904310, -54856032, -54774849, -54660927, -54514451, -54335625,
+	-54124669, -53881826, -53607353, -53301528, -52964644, -52597014,
+	-52198966, -51770848, -51313021, -50825865, -50309777, -49765166,
+	-49192461, -48592104, -47964552, -47310278, -46629766, -45923519,
+	-45192049, -44435884, -43655564, -42851642, -42024683, -41175263,
+	-40303970, -39411404, -38498174, -37564901, -36612214, -35640752,
+	-34651165, -33644108, -32620247, -31580254, -30524811, -29454603,
+	-28370325, -27272676, -26162361, -25040091, -23906581, -22762549,
+	-21608720, -20445819, -19274576, -18095724, -16909995, -15718127,
+	-14520855, -13318917, -12113051, -10903995, -9692485, -8479259,
+	-7265049, -6050590, -4836611, -3623840, -2413001, -1204816,
+	0, 1200733, 2396677, 3587128, 4771391, 5948775,
+	7118596, 8280176, 9432845, 10575941, 11708810, 12830804,
+	13941287, 15039631, 16125214, 17197430, 18255677, 19299367,
+	20327922, 21340774, 22337367, 23317156, 24279609, 25224206,
+	26150438, 27057810, 27945840, 28814058, 29662008, 30489249,
+	31295352, 32079902, 32842500, 33582761, 34300312, 34994799,
+	35665881, 36313231, 36936538, 37535509, 38109863, 38659335,
+	39183679, 39682661, 40156066, 40603692, 41025357, 41420891,
+	41790142, 42132977, 42449274, 42738930, 43001861, 43237993,
+	43447275, 43629666, 43785147, 43913712, 44015371, 44090151,
+	44138095, 44159261, 44153725, 44121577, 44062922, 43977882,
+	43866595, 43729213, 43565903, 43376847, 43162243, 42922303,
+	42657253, 42367335, 42052802, 41713925, 41350985, 40964279,
+	40554116, 40120818, 39664722, 39186174, 38685536, 38163179,
+	37619488, 37054858, 36469697, 35864422, 35239462, 34595257,
+	33932256, 33250918, 32551712, 31835115, 31101615, 30351706,
+	29585893, 28804688, 28008608, 27198182, 26373942, 25536428,
+	24686187, 23823770, 22949736, 22064647, 21169071, 20263581,
+	19348752, 18425164, 17493402, 16554052, 15607703, 14654947,
+	13696377, 12732589, 11764179, 10791744, 9815883, 8837193,
+	7856272, 6873718, 5890127, 4906094, 3922213, 2939075,
+	1957270, 977383, 0, -974300, -1944941, -2911350,
+	-3872957, -4829201, -5779522, -6723367, -7660188, -8589444,
+	-9510599, -10423124, -11326497, -12220202, -13103733, -13976590,
+	-14838280, -15688320, -16526235, -17351558, -18163832, -18962609,
+	-19747450, -20517926, -21273619, -22014120, -22739029, -23447961,
+	-24140537, -24816392, -25475170, -26116530, -26740138, -27345675,
+	-27932831, -28501312, -29050833, -29581121, -30091918, -30582975,
+	-31054060, -31504950, -31935437, -32345324, -32734428, -33102580,
+	-33449623, -33775413, -34079820, -34362727, -34624029, -34863637,
+	-35081473, -35277473, -35451586, -35603776, -35734017, -35842300,
+	-35928628, -35993014, -36035489, -36056094, -36054885, -36031928,
+	-35987306, -35921110, -35833448, -35724439, -35594212, -35442913,
+	-35270696, -35077731, -34864195, -34630282, -34376195, -34102148,
+	-33808367, -33495091, -33162566, -32811054, -32440822, -32052152,
+	-31645334, -31220669, -30778466, -30319046, -29842738, -29349880,
+	-28840820, -28315914, -27775526, -27220029, -26649804, -26065239,
+	-25466729, -24854678, -24229496, -23591599, -22941409, -22279357,
+	-21605877, -20921410, -20226400, -19521300, -18806563, -18082650,
+	-17350026, -16609157, -15860515, -15104575, -14341814, -13572712,
+	-12797752, -12017418, -11232198, -10442578, -9649048, -8852097,
+	-8052217, -7249897, -6445629, -5639904, -4833210, -4026037,
+	-3218873, -2412203, -1606513, -802286, 0, 799866,
+	1596838, 2390443, 3180215, 3965689, 4746404, 5521905,
+	6291739, 7055461, 7812627, 8562802, 9305555, 10040460,
+	10767098, 11485056, 12193927, 12893312, 13582818, 14262058,
+	14930655, 15588237, 16234440, 16868911, 17491301, 18101271,
+	18698492, 19282642, 19853407, 20410483, 20953577, 21482402,
+	21996683, 22496153, 22980555, 23449642, 23903178, 24340936,
+	24762699, 25168260, 25557424, 25930004, 26285827, 26624727,
+	26946550, 27251154, 27538407, 27808186, 28060382, 28294895,
+	28511636, 28710528, 28891503, 29054507, 29199494, 29326431,
+	29435294, 29526073, 29598765, 29653382, 29689944, 29708482,
+	29709039, 29691669, 29656434, 29603409, 29532680, 29444340,
+	29338497, 29215265, 29074770, 28917149, 28742547, 28551120,
+	28343033, 28118462, 27877589, 27620610, 27347726, 27059149,
+	26755100, 26435808, 26101510, 25752453, 25388891, 25011085,
+	24619306, 24213831, 23794946, 23362942, 22918119, 22460783,
+	21991246, 21509828, 21016855, 20512657, 19997572, 19471943,
+	18936117, 18390448, 17835294, 17271017, 16697986, 16116570,
+	15527146, 14930093, 14325793, 13714632, 13096999, 12473284,
+	11843883, 11209192, 10569608, 9925533, 9277367, 8625513,
+	7970376, 7312360, 6651871, 5989314, 5325095, 4659618,
+	3993290, 3326515, 2659695, 1993234, 1327532, 662988,
+	0, -661037, -1319730, -1975689, -2628527, -3277857,
+	-3923300, -4564478, -5201016, -5832544, -6458696, -7079110,
+	-7693429, -8301299, -8902374, -9496311, -10082773, -10661427,
+	-11231949, -11794016, -12347316, -12891540, -13426387, -13951561,
+	-14466774, -14971745, -15466199, -15949869, -16422494, -16883823,
+	-17333608, -17771615, -18197611, -18611377, -19012697, -19401367,
+	-19777189, -20139974, -20489541, -20825719, -21148343, -21457259,
+	-21752320, -22033390, -22300338, -22553047, -22791405, -23015310,
+	-23224669, -23419400, -23599426, -23764683, -23915113, -24050671,
+	-24171317, -24277022, -24367766, -24443539, -24504338, -24550170,
+	-24581051, -24597007, -24598072, -24584288, -24555707, -24512390,
+	-24454406, -24381833, -24294756, -24193272, -24077483, -23947502,
+	-23803447, -23645447, -23473638, -23288165, -23089178, -22876837,
+	-22651310, -22412771, -22161403, -21897393, -21620939, -21332243,
+	-21031515, -20718973, -20394839, -20059342, -19712719, -19355210,
+	-18987063, -18608532, -18219875, -17821356, -17413245, -16995815,
+	-16569346, -16134122, -15690430, -15238564, -14778819, -14311496,
+	-13836900, -13355337, -12867119, -12372559, -11871975, -11365687,
+	-10854016, -10337287, -9815826, -9289963, -8760027, -8226349,
+	-7689264, -7149104, -6606205, -6060903, -5513533, -4964433,
+	-4413937, -3862383, -3310107, -2757444, -2204729, -1652295,
+	-1100475, -549600, 0, 547997, 1094065, 1637880,
+	2179120, 2717467, 3252603, 3784216, 4311994, 4835630,
+	5354821, 5869265, 6378667, 6882732, 7381174, 7873707,
+	8360051, 8839930, 9313075, 9779218, 10238100, 10689463,
+	11133058, 11568640, 11995969, 12414810, 12824937, 13226126,
+	13618162, 14000835, 14373940, 14737282, 15090668, 15433915,
+	15766844, 16089286, 16401075, 16702055, 16992076, 17270994,
+	17538673, 17794985, 18039808, 18273028, 18494537, 18704236,
+	18902034, 19087844, 19261591, 19423203, 19572620, 19709786,
+	19834655, 19947186, 20047349, 20135117, 20210475, 20273413,
+	20323930, 20362031, 20387729, 20401046, 20402008, 20390652,
+	20367020, 20331162, 20283136, 20223006, 20150844, 20066728,
+	19970744, 19862984, 19743549, 19612543, 19470081, 19316280,
+	19151269, 18975177, 18788145, 18590317, 18381845, 18162884,
+	17933597, 17694155, 17444729, 17185501, 16916655, 16638382,
+	16350877, 16054341, 15748980, 15435002, 15112624, 14782064,
+	14443546, 14097297, 13743548, 13382537, 13014501, 12639684,
+	12258331, 11870692, 11477019, 11077568, 10672597, 10262366,
+	9847138, 9427179, 9002757, 8574140, 8141600, 7705409,
+	7265841, 6823172, 6377678, 5929636, 5479324, 5027022,
+	4573007, 4117559, 3660958, 3203481, 2745409, 2287020,
+	1828590, 1370398, 912720, 455829, 0, -454495,
+	-907385, -1358402, -1807279, -2253751, -2697555, -3138431,
+	-3576122, -4010372, -4440929, -4867544, -5289972, -5707968,
+	-6121293, -6529712, -6932993, -7330906, -7723227, -8109736,
+	-8490216, -8864455, -9232246, -9593384, -9947671, -10294914,
+	-10634924, -10967515, -11292510, -11609734, -11919018, -12220198,
+	-12513117, -12797622, -13073565, -13340806, -13599207, -13848640,
+	-14088979, -14320106, -14541909, -14754281, -14957121, -15150334,
+	-15333834, -15507536, -15671364, -15825250, -15969129, -16102943,
+	-16226641, -16340179, -16443517, -16536623, -16619471, -16692041,
+	-16754319, -16806298, -16847976, -16879360, -16900459, -16911292,
+	-16911883, -16902260, -16882460, -16852525, -16812502, -16762446,
+	-16702416, -16632478, -16552703, -16463169, -16363957, -16255157,
+	-16136863, -16009173, -15872193, -15726033, -15570808, -15406639,
+	-15233650, -15051974, -14861744, -14663101, -14456191, -14241161,
+	-14018167, -13787365, -13548920, -13302997, -13049767, -12789404,
+	-12522087, -12247998, -11967322, -11680249, -11386970, -11087682,
+	-10782582, -10471873, -10155759, -9834445, -9508143, -9177064,
+	-8841422, -8501433, -8157316, -7809290, -7457578, -7102402,
+	-6743989, -6382563, -6018353, -5651586, -5282492, -4911300,
+	-4538241, -4163546, -3787447, -3410174, -3031959, -2653033,
+	-2273628, -1893974, -1514302, -1134840, -755817, -377462,
+	0, 376342, 751341, 1124775, 1496421, 1866061,
+	2233477, 2598454, 2960779, 3320240, 3676629, 4029740,
+	4379368, 4725314, 5067378, 5405366, 5739085, 6068347,
+	6392965, 6712758, 7027547, 7337155, 7641412, 7940149,
+	8233203, 8520412, 8801622, 9076679, 9345436, 9607749,
+	9863479, 10112491, 10354654, 10589842, 10817935, 11038814,
+	11252369, 11458492, 11657081, 11848037, 12031269, 12206689,
+	12374213, 12533765, 12685271, 12828663, 12963881, 13090865,
+	13209564, 13319932, 13421925, 13515508, 13600648, 13677320,
+	13745503, 13805181, 13856343, 13898983, 13933102, 13958703,
+	13975798, 13984401, 13984533, 13976218, 13959487, 13934376,
+	13900924, 13859176, 13809184, 13751001, 13684687, 13610307,
+	13527930, 13437629, 13339484, 13233576, 13119993, 12998827,
+	12870173, 12734133, 12590809, 12440312, 12282752, 12118248,
+	11946918, 11768887, 11584283, 11393237, 11195884, 10992363,
+	10782813, 10567382, 10346215, 10119465, 9887286, 9649833,
+	9407266, 9159748, 8907442, 8650516, 8389139, 8123483,
+	7853720, 7580027, 7302580, 7021559, 6737144, 6449517,
+	6158863, 5865365, 5569210, 5270585, 4969678, 4666678,
+	4361774, 4055156, 3747015, 3437542, 3126928, 2815364,
+	2503041, 2190150, 1876883, 1563429, 1249980, 936724,
+	623850, 311546, 0, -310603, -620077, -928240,
+	-1234908, -1539901, -1843039, -2144145, -2443042, -2739558,
+	-3033519, -3324756, -3613101, -3898388, -4180455, -4459139,
+	-4734284, -5005733, -5273334, -5536936, -5796392, -6051558,
+	-6302293, -6548458, -6789919, -7026543, -7258203, -7484774,
+	-7706133, -7922163, -8132750, -8337782, -8537154, -8730760,
+	-8918502, -9100285, -9276016, -9445607, -9608975, -9766040,
+	-9916726, -10060962, -10198679, -10329815, -10454311, -10572110,
+	-10683163, -10787423, -10884848, -10975399, -11059043, -11135750,
+	-11205496, -11268259, -11324022, -11372774, -11414506, -11449215,
+	-11476900, -11497568, -11511226, -11517888, -11517572, -11510298,
+	-11496093, -11474987, -11447013, -11412210, -11370619, -11322286,
+	-11267262, -11205599, -11137357, -11062596, -10981381, -10893781,
+	-10799870, -10699723, -10593419, -10481043, -10362681, -10238422,
+	-10108361, -9972593, -9831218, -9684340, -9532063, -9374497,
+	-9211753, -9043945, -8871191, -8693611, -8511326, -8324461,
+	-8133145, -7937505, -7737674, -7533785, -7325975, -7114380,
+	-6899142, -6680401, -6458300, -6232985, -6004601, -5773296,
+	-5539218, -5302519, -5063350, -4821862, -4578209, -4332545,
+	-4085025, -3835804, -3585039, -3332886, -3079501, -2825042,
+	-2569667, -2313531, -2056793, -1799611, -1542139, -1284537,
+	-1026959, -769562, -512500, -255928, 0, 255131,
+	509314, 762398, 1014233, 1264670, 1513563, 1760766,
+	2006134, 2249524, 2490796, 2729811, 2966430, 3200518,
+	3431941, 3660568, 3886269, 4108916, 4328385, 4544552,
+	4757298, 4966503, 5172053, 5373835, 5571738, 5765654,
+	5955480, 6141112, 6322452, 6499403, 6671872, 6839769,
+	7003007, 7161500, 7315169, 7463935, 7607724, 7746465,
+	7880089, 8008531, 8131730, 8249628, 8362170, 8469306,
+	8570986, 8667167, 8757809, 8842872, 8922324, 8996134,
+	9064276, 9126725, 9183462, 9234470, 9279737, 9319254,
+	9353015, 9381016, 9403261, 9419752, 9430499, 9435514,
+	9434810, 9428407, 9416326, 9398593, 9375237, 9346288,
+	9311783, 9271760, 9226261, 9175330, 9119015, 9057368,
+	8990442, 8918296, 8840988, 8758583, 8671146, 8578746,
+	8481455, 8379347, 8272500, 8160992, 8044907, 7924328,
+	7799344, 7670044, 7536520, 7398866, 7257178, 7111555,
+	6962099, 6808910, 6652095, 6491759, 6328011, 6160960,
+	5990719, 5817400, 5641118, 5461990, 5280132, 5095665,
+	4908706, 4719379, 4527804, 4334105, 4138406, 3940832,
+	3741508, 3540561, 3338118, 3134305, 2929250, 2723083,
+	2515930, 2307920, 2099183, 1889847, 1680040, 1469890,
+	1259527, 1049079, 838672, 628434, 418492, 208972,
+	0, -208300, -415805, -622390, -827934, -1032315,
+	-1235415, -1437113, -1637293, -1835837, -2032632, -2227563,
+	-2420520, -2611390, -2800066, -2986440, -3170406, -3351863,
+	-3530706, -3706838, -3880159, -4050574, -4217989, -4382313,
+	-4543456, -4701331, -4855853, -5006939, -5154508, -5298484,
+	-5438790, -5575353, -5708102, -5836971, -5961893, -6082805,
+	-6199647, -6312362, -6420896, -6525194, -6625210, -6720895,
+	-6812205, -6899101, -6981543, -7059497, -7132929, -7201809,
+	-7266112, -7325812, -7380890, -7431325, -7477104, -7518213,
+	-7554643, -7586388, -7613442, -7635805, -7653479, -7666469,
+	-7674782, -7678427, -7677419, -7671773, -7661507, -7646643,
+	-7627206, -7603221, -7574718, -7541729, -7504289, -7462435,
+	-7416208, -7365648, -7310802, -7251715, -7188439, -7121025,
+	-7049528, -6974004, -6894512, -6811113, -6723871, -6632851,
+	-6538121, -6439751, -6337811, -6232376, -6123520, -6011321,
+	-5895858, -5777212, -5655464, -5530699, -5403003, -5272462,
+	-5139165, -5003202, -4864663, -4723641, -4580231, -4434526,
+	-4286622, -4136616, -3984607, -3830692, -3674971, -3517545,
+	-3358515, -3197982, -3036048, -2872816, -2708389, -2542871,
+	-2376366, -2208978, -2040810, -1871969, -1702557, -1532680,
+	-1362442, -1191947, -1021299, -850603, -679961, -509478,
+	-339255, -169395, 0, 168830, 336993, 504391,
+	670924, 836495, 1001006, 1164362, 1326467, 1487227,
+	1646550, 1804343, 1960516, 2114981, 2267648, 2418433,
+	2567249, 2714013, 2858643, 3001059, 3141182, 3278935,
+	3414242, 3547029, 3677225, 3804759, 3929562, 4051570,
+	4170716, 4286940, 4400179, 4510375, 4617472, 4721416,
+	4822154, 4919635, 5013813, 5104640, 5192074, 5276072,
+	5356596, 5433607, 5507073, 5576959, 5643236, 5705876,
+	5764854, 5820145, 5871728, 5919586, 5963702, 6004061,
+	6040653, 6073467, 6102496, 6127736, 6149184, 6166841,
+	6180708, 6190790, 6197093, 6199627, 6198403, 6193435,
+	6184737, 6172329, 6156230, 6136462, 6113051, 6086022,
+	6055404, 6021229, 5983529, 5942339, 5897695, 5849637,
+	5798206, 5743443, 5685394, 5624105, 5559625, 5492002,
+	5421290, 5347541, 5270810, 5191155, 5108633, 5023305,
+	4935231, 4844474, 4751100, 4655172, 4556758, 4455927,
+	4352748, 4247290, 4139627, 4029831, 3917975, 3804135,
+	3688386, 3570806, 3451471, 3330460, 3207852, 3083728,
+	2958166, 2831250, 2703059, 2573677, 2443185, 2311667,
+	2179205, 2045884, 1911788, 1776999, 1641603, 1505683,
+	1369323, 1232609, 1095623, 958450, 821173, 683877,
+	546644, 409558, 272700, 136154, 0, -135680,
+	-270805, -405295, -539072, -672057, -804171, -935337,
+	-1065481, -1194525, -1322396, -1449021, -1574326, -1698242,
+	-1820696, -1941621, -2060948, -2178610, -2294542, -2408681,
+	-2520962, -2631324, -2739708, -2846054, -2950305, -3052405,
+	-3152300, -3249937, -3345265, -3438234, -3528795, -3616904,
+	-3702514, -3785583, -3866068, -3943932, -4019135, -4091641,
+	-4161416, -4228427, -4292643, -4354036, -4412577, -4468242,
+	-4521007, -4570850, -4617751, -4661692, -4702657, -4740632,
+	-4775604, -4807563, -4836500, -4862407, -4885281, -4905118,
+	-4921916, -4935677, -4946402, -4954096, -4958766, -4960418,
+	-4959063, -4954712, -4947378, -4937077, -4923825, -4907641,
+	-4888545, -4866560, -4841707, -4814014, -4783506, -4750213,
+	-4714164, -4675391, -4633928, -4589808, -4543070, -4493749,
+	-4441885, -4387519, -4330693, -4271449, -4209833, -4145890,
+	-4079668, -4011214, -3940579, -3867813, -3792967, -3716095,
+	-3637250, -3556488, -3473863, -3389434, -3303257, -3215392,
+	-3125897, -3034833, -2942260, -2848241, -2752837, -2656111,
+	-2558126, -2458948, -2358639, -2257266, -2154892, -2051585,
+	-1947410, -1842433, -1736721, -1630341, -1523359, -1415843,
+	-1307860, -1199477, -1090761, -981780, -872600, -763288,
+	-653911, -544537, -435230, -326057, -217085, -108377,
+	0, 107983, 215506, 322508, 428924, 534692,
+	639750, 744038, 847495, 950061, 1051677, 1152284,
+	1251827, 1350247, 1447491, 1543501, 1638226, 1731613,
+	1823608, 1914163, 2003227, 2090751, 2176689, 2260993,
+	2343619, 2424523, 2503662, 2580994, 2656479, 2730079,
+	2801755, 2871471, 2939191, 3004883, 3068514, 3130052,
+	3189469, 3246735, 3301825, 3354712, 3405373, 3453785,
+	3499928, 3543781, 3585326, 3624547, 3661428, 3695956,
+	3728119, 3757905, 3785306, 3810314, 3832922, 3853125,
+	3870921, 3886307, 3899284, 3909851, 3918012, 3923770,
+	3927132, 3928103, 3926692, 3922910, 3916766, 3908274,
+	3897448, 3884302, 3868854, 3851121, 3831122, 3808879,
+	3784413, 3757747, 3728906, 3697915, 3664801, 3629592,
+	3592318, 3553008, 3511695, 3468411, 3423189, 3376064,
+	3327072, 3276249, 3223634, 3169266, 3113182, 3055425,
+	2996036, 2935055, 2872528, 2808497, 2743007, 2676103,
+	2607832, 2538239, 2467372, 2395279, 2322008, 2247608,
+	2172129, 2095620, 2018131, 1939715, 1860421, 1780301,
+	1699407, 1617790, 1535504, 1452601, 1369132, 1285152,
+	1200713, 1115868, 1030670, 945172, 859428, 773490,
+	687410, 601243, 515040, 428854, 342738, 256742,
+	170920, 85322, 0, -84996, -169615, -253808,
+	-337524, -420715, -503333, -585329, -666656, -747268,
+	-827117, -906159, -984348, -1061641, -1137993, -1213363,
+	-1287707, -1360986, -1433158, -1504184, -1574025, -1642643,
+	-1710002, -1776066, -1840798, -1904166, -1966135, -2026674,
+	-2085752, -2143337, -2199402, -2253917, -2306856, -2358192,
+	-2407901, -2455959, -2502342, -2547030, -2590002, -2631237,
+	-2670719, -2708429, -2744353, -2778474, -2810779, -2841255,
+	-2869892, -2896679, -2921606, -2944667, -2965853, -2985161,
+	-3002584, -3018121, -3031768, -3043525, -3053393, -3061372,
+	-3067465, -3071677, -3074010, -3074473, -3073071, -3069812,
+	-3064707, -3057765, -3048997, -3038417, -3026038, -3011873,
+	-2995940, -2978255, -2958834, -2937697, -2914864, -2890355,
+	-2864191, -2836395, -2806990, -2776000, -2743451, -2709368,
+	-2673778, -2636709, -2598189, -2558247, -2516913, -2474218,
+	-2430192, -2384869, -2338280, -2290459, -2241441, -2191258,
+	-2139947, -2087544, -2034083, -1979603, -1924140, -1867732,
+	-1810416, -1752232, -1693218, -1633413, -1572856, -1511589,
+	-1449649, -1387079, -1323918, -1260207, -1195988, -1131300,
+	-1066186, -1000686, -934842, -868695, -802288, -735660,
+	-668853, -601910, -534870, -467776, -400668, -333586,
+	-266573, -199667, -132910, -66341, 0, 66074,
+	131841, 197263, 262301, 326918, 391075, 454737,
+	517865, 580424, 642379, 703693, 764332, 824262,
+	883450, 941863, 999468, 1056233, 1112127, 1167120,
+	1221183, 1274285, 1326399, 1377497, 1427552, 1476538,
+	1524429, 1571201, 1616830, 1661293, 1704567, 1746631,
+	1787465, 1827048, 1865362, 1902389, 1938110, 1972511,
+	2005575, 2037288, 2067635, 2096605, 2124185, 2150364,
+	2175132, 2198479, 2220398, 2240881, 2259920, 2277512,
+	2293650, 2308331, 2321552, 2333311, 2343607, 2352440,
+	2359810, 2365719, 2370169, 2373163, 2374707, 2374804,
+	2373461, 2370685, 2366482, 2360862, 2353834, 2345408,
+	2335595, 2324406, 2311855, 2297953, 2282716, 2266159,
+	2248296, 2229144, 2208720, 2187042, 2164128, 2139998,
+	2114670, 2088166, 2060506, 2031712, 2001807, 1970812,
+	1938752, 1905650, 1871532, 1836421, 1800344, 1763326,
+	1725394, 1686575, 1646895, 1606384, 1565069, 1522978,
+	1480140, 1436585, 1392342, 1347441, 1301912, 1255785,
+	1209091, 1161860, 1114124, 1065914, 1017261, 968196,
+	918752, 868959, 818851, 768457, 717811, 666944,
+	615888, 564675, 513337, 461905, 410411, 358887,
+	307365, 255875, 204449, 153118, 101912, 50863,
+	0, -50646, -101045, -151168, -200985, -250467,
+	-299586, -348313, -396621, -444481, -491867, -538752,
+	-585108, -630912, -676136, -720755, -764746, -808084,
+	-850746, -892708, -933948, -974444, -1014175, -1053119,
+	-1091256, -1128567, -1165033, -1200634, -1235353, -1269173,
+	-1302076, -1334048, -1365071, -1395133, -1424217, -1452312,
+	-1479403, -1505480, -1530530, -1554542, -1577507, -1599416,
+	-1620258, -1640027, -1658714, -1676314, -1692820, -1708227,
+	-1722531, -1735726, -1747811, -1758782, -1768639, -1777379,
+	-1785002, -1791509, -1796900, -1801176, -1804342, -1806398,
+	-1807349, -1807199, -1805953, -1803616, -1800195, -1795697,
+	-1790128, -1783497, -1775813, -1767086, -1757324, -1746538,
+	-1734740, -1721941, -1708154, -1693390, -1677664, -1660989,
+	-1643379, -1624850, -1605417, -1585095, -1563901, -1541851,
+	-1518963, -1495255, -1470744, -1445449, -1419389, -1392583,
+	-1365051, -1336813, -1307889, -1278299, -1248065, -1217209,
+	-1185750, -1153713, -1121117, -1087987, -1054344, -1020211,
+	-985611, -950568, -915104, -879244, -843010, -806427,
+	-769518, -732307, -694819, -657077, -619106, -580929,
+	-542571, -504056, -465409, -426653, -387812, -348911,
+	-309973, -271023, -232084, -193179, -154334, -115570,
+	-76911, -38380, 0, 38206, 76216, 114007,
+	151558, 188846, 225850, 262549, 298922, 334949,
+	370608, 405879, 440744, 475182, 509175, 542703,
+	575749, 608295, 640322, 671815, 702755, 733127,
+	762915, 792104, 820677, 848621, 875922, 902565,
+	928539, 953828, 978423, 1002310, 1025478, 1047917,
+	1069616, 1090566, 1110757, 1130179, 1148826, 1166689,
+	1183761, 1200035, 1215505, 1230164, 1244009, 1257034,
+	1269235, 1280609, 1291151, 1300861, 1309735, 1317772,
+	1324972, 1331333, 1336855, 1341540, 1345388, 1348400,
+	1350580, 1351928, 1352449, 1352146, 1351022, 1349083,
+	1346333, 1342778, 1338424, 1333277, 1327344, 1320632,
+	1313149, 1304904, 1295904, 1286158, 1275677, 1264470,
+	1252548, 1239920, 1226598, 1212593, 1197918, 1182583,
+	1166603, 1149988, 1132753, 1114911, 1096476, 1077462,
+	1057882, 1037753, 1017087, 995902, 974212, 952032,
+	929379, 906269, 882717, 858741, 834357, 809581,
+	784432, 758925, 733078, 706909, 680435, 653674,
+	626643, 599360, 571844, 544111, 516180, 488068,
+	459795, 431378, 402834, 374183, 345441, 316628,
+	287760, 258856, 229934, 201011, 172105, 143233,
+	114413, 85663, 56999, 28439, 0, -28302,
+	-56450, -84428, -112219, -139807, -167177, -194312,
+	-221198, -247819, -274160, -300206, -325943, -351357,
+	-376434, -401160, -425521, -449505, -473099, -496290,
+	-519066, -541415, -563326, -584787, -605788, -626317,
+	-646365, -665922, -684978, -703523, -721550, -739050,
+	-756014, -772435, -788306, -803619, -818367, -832546,
+	-846148, -859168, -871602, -883444, -894690, -905336,
+	-915379, -924816, -933643, -941858, -949460, -956447,
+	-962817, -968569, -973704, -978221, -982120, -985403,
+	-988069, -990122, -991561, -992390, -992611, -992227,
+	-991241, -989657, -987479, -984711, -981357, -977423,
+	-972914, -967836, -962194, -955994, -949245, -941951,
+	-934121, -925761, -916881, -907486, -897587, -887192,
+	-876309, -864947, -853117, -840827, -828087, -814908,
+	-801299, -787271, -772836, -758002, -742783, -727189,
+	-711231, -694921, -678272, -661293, -643999, -626401,
+	-608510, -590341, -571905, -553214, -534282, -515122,
+	-495746, -476167, -456398, -436452, -416343, -396084,
+	-375687, -355165, -334533, -313803, -292989, -272103,
+	-251159, -230170, -209148, -188108, -167061, -146021,
+	-125001, -104013, -83070, -62185, -41370, -20638,
+	0, 20531, 40943, 61224, 81362, 101347,
+	121166, 140808, 160262, 179517, 198563, 217388,
+	235983, 254338, 272441, 290284, 307857, 325151,
+	342156, 358864, 375265, 391352, 407117, 422550,
+	437645, 452394, 466790, 480826, 494496, 507791,
+	520708, 533239, 545379, 557123, 568466, 579402,
+	589927, 600037, 609728, 618996, 627838, 636251,
+	644231, 651776, 658884, 665552, 671780, 677565,
+	682906, 687802, 692254, 696259, 699819, 702934,
+	705603, 707828, 709610, 710949, 711848, 712309,
+	712333, 711922, 711080, 709808, 708111, 705991,
+	703453, 700499, 697134, 693362, 689188, 684616,
+	679651, 674299, 668565, 662454, 655972, 649126,
+	641921, 634363, 626460, 618217, 609642, 600743,
+	591525, 581997, 572165, 562039, 551625, 540931,
+	529966, 518737, 507254, 495523, 483555, 471358,
+	458940, 446310, 433477, 420450, 407238, 393850,
+	380296, 366584, 352725, 338726, 324598, 310350,
+	295991, 281531, 266979, 252345, 237638, 222867,
+	208042, 193172, 178267, 163336, 148388, 133433,
+	118479, 103537, 88614, 73720, 58865, 44056,
+	29303, 14615, 0, -14533, -28977, -43321,
+	-57559, -71682, -85682, -99551, -113281, -126865,
+	-140296, -153565, -166665, -179590, -192333, -204886,
+	-217243, -229398, -241344, -253075, -264585, -275869,
+	-286920, -297734, -308304, -318626, -328694, -338505,
+	-348054, -357335, -366345, -375081, -383537, -391711,
+	-399599, -407198, -414505, -421517, -428232, -434646,
+	-440758, -446566, -452068, -457262, -462147, -466721,
+	-470985, -474935, -478574, -481898, -484909, -487607,
+	-489991, -492062, -493820, -495267, -496403, -497228,
+	-497745, -497955, -497860, -497461, -496760, -495760,
+	-494463, -492871, -490987, -488814, -486355, -483614,
+	-480593, -477295, -473726, -469888, -465785, -461421,
+	-456801, -451929, -446810, -441447, -435846, -430012,
+	-423949, -417663, -411159, -404442, -397517, -390390,
+	-383066, -375552, -367853, -359974, -351922, -343703,
+	-335323, -326787, -318102, -309274, -300310, -291216,
+	-281998, -272662, -263216, -253664, -244015, -234275,
+	-224449, -214546, -204570, -194529, -184430, -174278,
+	-164081, -153845, -143576, -133281, -122967, -112640,
+	-102307, -91973, -81646, -71331, -61035, -50764,
+	-40525, -30322, -20164, -10054, 0, 9993,
+	19919, 29772, 39547, 49238, 58840, 68347,
+	77754, 87055, 96247, 105323, 114279, 123110,
+	131812, 140379, 148808, 157094, 165232, 173219,
+	181051, 188724, 196234, 203577, 210750, 217749,
+	224572, 231215, 237675, 243950, 250036, 255931,
+	261632, 267138, 272446, 277554, 282461, 287163,
+	291660, 295951, 300033, 303906, 307568, 311019,
+	314258, 317284, 320096, 322695, 325080, 327250,
+	329206, 330948, 332476, 333791, 334893, 335783,
+	336461, 336929, 337188, 337238, 337081, 336718,
+	336152, 335383, 334413, 333244, 331879, 330318,
+	328566, 326623, 324492, 322176, 319677, 316998,
+	314142, 311112, 307911, 304541, 301006, 297309,
+	293454, 289444, 285282, 280972, 276517, 271922,
+	267190, 262324, 257330, 252209, 246968, 241608,
+	236136, 230554, 224867, 219079, 213195, 207218,
+	201154, 195005, 188777, 182474, 176100, 169660,
+	163158, 156599, 149987, 143326, 136622, 129877,
+	123098, 116287, 109450, 102591, 95715, 88825,
+	81927, 75024, 68121, 61222, 54331, 47453,
+	40591, 33750, 26934, 20147, 13393, 6676,
+	0, -6631, -13214, -19745, -26219, -32634,
+	-38986, -45271, -51486, -57628, -63692, -69676,
+	-75578, -81392, -87118, -92751, -98289, -103728,
+	-109068, -114303, -119433, -124455, -129366, -134163,
+	-138846, -143411, -147857, -152181, -156383, -160459,
+	-164409, -168230, -171922, -175482, -178911, -182205,
+	-185365, -188389, -191276, -194025, -196637, -199109,
+	-201441, -203634, -205685, -207596, -209366, -210995,
+	-212483, -213829, -215035, -216100, -217024, -217808,
+	-218453, -218959, -219326, -219556, -219649, -219606,
+	-219428, -219116, -218672, -218096, -217390, -216555,
+	-215592, -214504, -213291, -211956, -210499, -208923,
+	-207229, -205420, -203497, -201463, -199319, -197067,
+	-194710, -192250, -189689, -187030, -184274, -181425,
+	-178484, -175455, -172339, -169139, -165858, -162498,
+	-159063, -155554, -151975, -148328, -144616, -140842,
+	-137008, -133118, -129174, -125179, -121135, -117047,
+	-112916, -108746, -104539, -100299, -96028, -91728,
+	-87404, -83058, -78692, -74310, -69914, -65508,
+	-61094, -56674, -52253, -47831, -43413, -39001,
+	-34598, -30206, -25828, -21467, -17125, -12805,
+	-8509, -4240, 0, 4208, 8382, 12519,
+	16618, 20675, 24689, 28658, 32579, 36451,
+	40270, 44036, 47746, 51399, 54992, 58523,
+	61992, 65396, 68734, 72004, 75204, 78334,
+	81391, 84374, 87282, 90115, 92869, 95545,
+	98141, 100657, 103091, 105443, 107711, 109894,
+	111993, 114007, 115934, 117775, 119528, 121194,
+	122771, 124261, 125662, 126974, 128197, 129332,
+	130377, 131333, 132201, 132980, 133670, 134272,
+	134787, 135213, 135553, 135806, 135972, 136053,
+	136049, 135961, 135789, 135535, 135198, 134780,
+	134282, 133705, 133049, 132316, 131507, 130623,
+	129665, 128634, 127532, 126359, 125118, 123808,
+	122433, 120992, 119489, 117923, 116296, 114611,
+	112868, 111070, 109217, 107311, 105354, 103348,
+	101294, 99194, 97049, 94862, 92633, 90366,
+	88061, 85720, 83345, 80938, 78501, 76035,
+	73542, 71024, 68483, 65921, 63339, 60738,
+	58122, 55492, 52849, 50195, 47532, 44862,
+	42186, 39507, 36826, 34144, 31463, 28786,
+	26114, 23447, 20789, 18140, 15503, 12878,
+	10268, 7673, 5096, 2538, 0, -2516,
+	-5009, -7478, -9921, -12336, -14723, -17081,
+	-19407, -21701, -23962, -26188, -28378, -30532,
+	-32648, -34726, -36763, -38760, -40715, -42627,
+	-44497, -46322, -48102, -49836, -51524, -53165,
+	-54758, -56303, -57799, -59246, -60643, -61990,
+	-63286, -64530, -65724, -66865, -67955, -68992,
+	-69977, -70910, -71789, -72616, -73390, -74111,
+	-74779, -75394, -75957, -76467, -76924, -77329,
+	-77682, -77983, -78233, -78431, -78578, -78675,
+	-78721, -78718, -78665, -78564, -78414, -78216,
+	-77972, -77680, -77343, -76960, -76532, -76061,
+	-75546, -74988, -74388, -73748, -73067, -72347,
+	-71587, -70791, -69957, -69087, -68182, -67242,
+	-66269, -65264, -64227, -63160, -62063, -60937,
+	-59784, -58605, -57400, -56170, -54916, -53640,
+	-52343, -51025, -49688, -48332, -46959, -45570,
+	-44166, -42747, -41315, -39871, -38417, -36952,
+	-35478, -33996, -32507, -31013, -29513, -28010,
+	-26504, -24996, -23487, -21979, -20471, -18966,
+	-17464, -15965, -14472, -12984, -11503, -10029,
+	-8564, -7109, -5663, -4229, -2806, -1396,
+	0, 1382, 2750, 4101, 5437, 6755,
+	8055, 9337, 10600, 11843, 13065, 14267,
+	15448, 16606, 17742, 18854, 19943, 21008,
+	22049, 23065, 24055, 25020, 25958, 26871,
+	27756, 28615, 29446, 30250, 31026, 31773,
+	32493, 33184, 33847, 34481, 35087, 35663,
+	36211, 36729, 37219, 37679, 38110, 38513,
+	38886, 39231, 39546, 39833, 40092, 40322,
+	40523, 40697, 40842, 40960, 41050, 41113,
+	41149, 41159, 41141, 41098, 41029, 40934,
+	40814, 40669, 40500, 40307, 40090, 39849,
+	39586, 39301, 38993, 38664, 38314, 37943,
+	37552, 37141, 36712, 36263, 35796, 35312,
+	34811, 34293, 33759, 33209, 32645, 32066,
+	31473, 30867, 30248, 29617, 28974, 28320,
+	27655, 26981, 26297, 25604, 24904, 24195,
+	23479, 22757, 22029, 21295, 20556, 19813,
+	19067, 18317, 17564, 16809, 16053, 15295,
+	14537, 13779, 13021, 12264, 11509, 10756,
+	10005, 9257, 8512, 7771, 7035, 6303,
+	5576, 4855, 4140, 3432, 2730, 2036,
+	1349, 670, 0, -662, -1314, -1958,
+	-2591, -3215, -3828, -4431, -5022, -5603,
+	-6172, -6730, -7275, -7809, -8330, -8839,
+	-9335, -9818, -10288, -10745, -11189, -11619,
+	-12035, -12438, -12827, -13202, -13563, -13910,
+	-14243, -14562, -14867, -15157, -15434, -15696,
+	-15944, -16178, -16397, -16603, -16794, -16971,
+	-17135, -17285, -17420, -17543, -17651, -17746,
+	-17828, -17897, -17952, -17995, -18025, -18042,
+	-18046, -18039, -18019, -17987, -17944, -17889,
+	-17823, -17746, -17657, -17559, -17449, -17330,
+	-17200, -17061, -16912, -16754, -16587, -16411,
+	-16226, -16034, -15833, -15625, -15409, -15186,
+	-14957, -14720, -14477, -14228, -13974, -13713,
+	-13448, -13178, -12902, -12623, -12339, -12051,
+	-11760, -11466, -11168, -10868, -10565, -10260,
+	-9952, -9644, -9333, -9022, -8709, -8396,
+	-8082, -7768, -7455, -7141, -6828, -6516,
+	-6204, -5894, -5585, -5278, -4973, -4669,
+	-4368, -4070, -3774, -3481, -3190, -2903,
+	-2620, -2340, -2063, -1790, -1522, -1257,
+	-996, -740, -489, -242, 0,
+};
@@ -0,0 +1,288 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/cdefs.h>
+__KERNEL_RCSID(0, "$NetBSD$");
+
+#include <sys/types.h>
+#include <sys/param.h>
+#include <sys/systm.h>
+#include <sys/errno.h>
+
+#include <dev/audio_if.h>
+
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+
+#ifdef _KERNEL
+#if defined(KMIXER_SIMD_X86)
+#include <machine/cpu.h>
+#include <machine/cpufunc.h>
+#include <machine/specialreg.h>
+#include <machine/fpu.h>
+#elif defined(KMIXER_SIMD_NEON)
+#include <machine/fpu.h>
+#endif
+#endif
+
+/* the vector kernels keep one dither generator per 32-bit lane */
+CTASSERT(KMIXER_DITHER_LANES == 8);
+
+static void
+kmixer_simd_mix_add_s16_scalar(int32_t *bus, const int16_t *src, u_int n)
+{
+	int64_t v;
+	u_int i;
+
+	for (i = 0; i < n; i++) {
+		v = (int64_t)bus[i] + (src[i] << KMIXER_SIMD_SHIFT16);
+		if (v > INT32_MAX)
+			v = INT32_MAX;
+		else if (v < INT32_MIN)
+			v = INT32_MIN;
+		bus[i] = (int32_t)v;
+	}
+}
+
+static void
+kmixer_simd_mix_out_s16_scalar(int16_t *dst, const int32_t *bus, u_int n)
+{
+	int32_t v;
+	u_int i;
+
+	for (i = 0; i < n; i++) {
+		v = bus[i];
+		if (v > KMIXER_BUS_MAX)
+			v = KMIXER_BUS_MAX;
+		else if (v < KMIXER_BUS_MIN)
+			v = KMIXER_BUS_MIN;
+		dst[i] = v >> KMIXER_SIMD_SHIFT16;
+	}
+}
+
+static void
+kmixer_simd_dither_s16_scalar(int32_t *bus, u_int n, uint32_t *seed)
+{
+	const int32_t lsb = 1 << KMIXER_SIMD_SHIFT16;
+	uint32_t x;
+	int32_t v;
+	u_int i;
+
+	for (i = 0; i < n; i++) {
+		x = seed[i % KMIXER_DITHER_LANES];
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		seed[i % KMIXER_DITHER_LANES] = x;
+		v = bus[i];
+		if (v > KMIXER_BUS_MAX)
+			v = KMIXER_BUS_MAX;
+		else if (v < KMIXER_BUS_MIN)
+			v = KMIXER_BUS_MIN;
+		v += lsb / 2 +
+		    kmixer_tpdf_table[x >> (32 - KMIXER_TPDF_BITS)] * (lsb >> 8);
+		bus[i] = v & ~(lsb - 1);
+	}
+}
+
+static void
+kmixer_simd_dup_s16_scalar(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	u_int i;
+
+	for (i = 0; i < nframes; i++) {
+		dst[2 * i] = src[i];
+		dst[2 * i + 1] = src[i];
+	}
+}
+
+static void
+kmixer_simd_downmix_s16_scalar(int16_t *dst, const int16_t *src,
+    u_int nframes)
+{
+	u_int i;
+
+	for (i = 0; i < nframes; i++)
+		dst[i] = (src[2 * i] + src[2 * i + 1]) / 2;
+}
+
+const struct kmixer_simd_ops kmixer_simd_scalar = {
+	.name = "scalar",
+	.fpu = false,
+	.mix_add_s16 = kmixer_simd_mix_add_s16_scalar,
+	.mix_out_s16 = kmixer_simd_mix_out_s16_scalar,
+	.dither_s16 = kmixer_simd_dither_s16_scalar,
+	.dup_s16 = kmixer_simd_dup_s16_scalar,
+	.downmix_s16 = kmixer_simd_downmix_s16_scalar,
+};
+
+static const struct kmixer_simd_ops *kmixer_simd = &kmixer_simd_scalar;
+
+static bool
+kmixer_simd_supported(const struct kmixer_simd_ops *ops)
+{
+#if defined(KMIXER_SIMD_X86)
+#ifdef _KERNEL
+	if (ops == &kmixer_simd_sse2)
+		return (cpu_feature[0] & CPUID_SSE2) != 0;
+	if (ops == &kmixer_simd_avx2)
+		return (cpu_feature[5] & CPUID_SEF_AVX2) != 0 &&
+		    (x86_xsave_features & XCR0_YMM_Hi128) != 0;
+#else
+	if (ops == &kmixer_simd_sse2)
+		return __builtin_cpu_supports("sse2");
+	if (ops == &kmixer_simd_avx2)
+		return __builtin_cpu_supports("avx2");
+#endif
+#endif
+	/* NEON is part of the aarch64 base architecture */
+	return true;
+}
+
+static const struct kmixer_simd_ops * const kmixer_simd_all[] = {
+#ifdef KMIXER_SIMD_X86
+	&kmixer_simd_avx2,
+	&kmixer_simd_sse2,
+#endif
+#ifdef KMIXER_SIMD_NEON
+	&kmixer_simd_neon,
+#endif
+	&kmixer_simd_scalar,
+};
+
+/*
+ * Pick the widest kernel set the CPU supports.
+ */
+void
+kmixer_simd_init(void)
+{
+	u_int i;
+
+	for (i = 0; i < __arraycount(kmixer_simd_all); i++) {
+		if (kmixer_simd_supported(kmixer_simd_all[i])) {
+			kmixer_simd = kmixer_simd_all[i];
+			break;
+		}
+	}
+}
+
+/*
+ * Force a kernel set by name, for comparing implementations.
+ */
+int
+kmixer_simd_select(const char *name)
+{
+	u_int i;
+
+	for (i = 0; i < __arraycount(kmixer_simd_all); i++) {
+		if (strcmp(kmixer_simd_all[i]->name, name) != 0)
+			continue;
+		if (!kmixer_simd_supported(kmixer_simd_all[i]))
+			return EOPNOTSUPP;
+		kmixer_simd = kmixer_simd_all[i];
+		return 0;
+	}
+	return ENOENT;
+}
+
+const char *
+kmixer_simd_name(void)
+{
+	return kmixer_simd->name;
+}
+
+/*
+ * The kernel only saves user FPU state on demand, so vector code has to
+ * be bracketed.
+ */
+#if defined(_KERNEL) && \
+    (defined(KMIXER_SIMD_X86) || defined(KMIXER_SIMD_NEON))
+#define KMIXER_SIMD_ENTER(ops)	\
+	do { \
+		if ((ops)->fpu) \
+			fpu_kern_enter(); \
+	} while (/*CONSTCOND*/ 0)
+#define KMIXER_SIMD_LEAVE(ops)	\
+	do { \
+		if ((ops)->fpu) \
+			fpu_kern_leave(); \
+	} while (/*CONSTCOND*/ 0)
+#else
+#define KMIXER_SIMD_ENTER(ops)	do { } while (/*CONSTCOND*/ 0)
+#define KMIXER_SIMD_LEAVE(ops)	do { } while (/*CONSTCOND*/ 0)
+#endif
+
+void
+kmixer_simd_mix_add_s16(int32_t *bus, const int16_t *src, u_int n)
+{
+	const struct kmixer_simd_ops *ops = kmixer_simd;
+
+	KMIXER_SIMD_ENTER(ops);
+	ops->mix_add_s16(bus, src, n);
+	KMIXER_SIMD_LEAVE(ops);
+}
+
+void
+kmixer_simd_mix_out_s16(int16_t *dst, const int32_t *bus, u_int n)
+{
+	const struct kmixer_simd_ops *ops = kmixer_simd;
+
+	KMIXER_SIMD_ENTER(ops);
+	ops->mix_out_s16(dst, bus, n);
+	KMIXER_SIMD_LEAVE(ops);
+}
+
+void
+kmixer_simd_dither_s16(int32_t *bus, u_int n, uint32_t *seed)
+{
+	const struct kmixer_simd_ops *ops = kmixer_simd;
+
+	KMIXER_SIMD_ENTER(ops);
+	ops->dither_s16(bus, n, seed);
+	KMIXER_SIMD_LEAVE(ops);
+}
+
+void
+kmixer_simd_dup_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	const struct kmixer_simd_ops *ops = kmixer_simd;
+
+	KMIXER_SIMD_ENTER(ops);
+	ops->dup_s16(dst, src, nframes);
+	KMIXER_SIMD_LEAVE(ops);
+}
+
+void
+kmixer_simd_downmix_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	const struct kmixer_simd_ops *ops = kmixer_simd;
+
+	KMIXER_SIMD_ENTER(ops);
+	ops->downmix_s16(dst, src, nframes);
+	KMIXER_SIMD_LEAVE(ops);
+}
@@ -0,0 +1,99 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _KMIXER_SIMD_H
+#define _KMIXER_SIMD_H
+
+#ifndef AUDIO_ENCODING_SLINEAR_NE
+#if BYTE_ORDER == LITTLE_ENDIAN
+#define AUDIO_ENCODING_SLINEAR_NE	AUDIO_ENCODING_SLINEAR_LE
+#else
+#define AUDIO_ENCODING_SLINEAR_NE	AUDIO_ENCODING_SLINEAR_BE
+#endif
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KMIXER_SIMD_X86
+#elif defined(__aarch64__)
+#define KMIXER_SIMD_NEON
+#endif
+
+/* shift between a 16-bit sample and the mix bus */
+#define KMIXER_SIMD_SHIFT16	(KMIXER_BUS_BITS - 16)
+
+/* channel mapping kernel, nframes source frames */
+typedef void kmixer_simd_map_t(int16_t *, const int16_t *, u_int);
+
+/*
+ * Vector kernels for native-endian 16-bit samples.  One set is picked by
+ * kmixer_simd_init() from the CPU features; the scalar set is always
+ * available and is the reference the others must match bit for bit,
+ * which "kmixer_bench -c" checks.
+ */
+struct kmixer_simd_ops {
+	const char	*name;
+	bool		fpu;		/* uses the FPU/vector unit */
+
+	/* bus[i] += src[i] << KMIXER_SIMD_SHIFT16, saturating */
+	void		(*mix_add_s16)(int32_t *, const int16_t *, u_int);
+	/* dst[i] = clip(bus[i]) >> KMIXER_SIMD_SHIFT16 */
+	void		(*mix_out_s16)(int16_t *, const int32_t *, u_int);
+	/*
+	 * Round the bus to 16 bits with TPDF dither, sample i taking the
+	 * generator seed[i % KMIXER_DITHER_LANES].
+	 */
+	void		(*dither_s16)(int32_t *, u_int, uint32_t *);
+	/*
+	 * Mono to stereo and stereo to mono, (l + r) / 2, at equal rates.
+	 * Only capture to 16-bit clients uses these: playback maps
+	 * channels on the 32-bit mix bus.
+	 */
+	kmixer_simd_map_t *dup_s16;
+	kmixer_simd_map_t *downmix_s16;
+};
+
+extern const struct kmixer_simd_ops kmixer_simd_scalar;
+#ifdef KMIXER_SIMD_X86
+extern const struct kmixer_simd_ops kmixer_simd_sse2;
+extern const struct kmixer_simd_ops kmixer_simd_avx2;
+#endif
+#ifdef KMIXER_SIMD_NEON
+extern const struct kmixer_simd_ops kmixer_simd_neon;
+#endif
+
+void	kmixer_simd_init(void);
+int	kmixer_simd_select(const char *);
+const char *kmixer_simd_name(void);
+
+void	kmixer_simd_mix_add_s16(int32_t *, const int16_t *, u_int);
+void	kmixer_simd_mix_out_s16(int16_t *, const int32_t *, u_int);
+void	kmixer_simd_dither_s16(int32_t *, u_int, uint32_t *);
+kmixer_simd_map_t kmixer_simd_dup_s16;
+kmixer_simd_map_t kmixer_simd_downmix_s16;
+
+#endif /* !_KMIXER_SIMD_H */
@@ -0,0 +1,209 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * AVX2 versions of the kmixer_simd kernels.  Most 256-bit shuffles and
+ * packs work within 128-bit lanes, so results are put back in order
+ * with a cross-lane permute.
+ */
+
+#include <sys/cdefs.h>
+__KERNEL_RCSID(0, "$NetBSD$");
+
+#include <sys/types.h>
+#include <sys/param.h>
+
+#include <dev/audio_if.h>
+
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+
+#ifdef KMIXER_SIMD_X86
+
+#include <immintrin.h>
+
+#define AVX2	__attribute__((__target__("avx2")))
+
+/* a + b, saturated to the int32_t range */
+static inline AVX2 __m256i
+kmixer_avx2_adds_epi32(__m256i a, __m256i b)
+{
+	const __m256i max = _mm256_set1_epi32(INT32_MAX);
+	__m256i s, ov, sat;
+
+	s = _mm256_add_epi32(a, b);
+	ov = _mm256_srai_epi32(_mm256_and_si256(_mm256_xor_si256(s, a),
+	    _mm256_xor_si256(s, b)), 31);
+	sat = _mm256_xor_si256(_mm256_srai_epi32(a, 31), max);
+	return _mm256_blendv_epi8(s, sat, ov);
+}
+
+static AVX2 void
+kmixer_avx2_mix_add_s16(int32_t *bus, const int16_t *src, u_int n)
+{
+	__m256i x;
+	u_int i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		x = _mm256_cvtepi16_epi32(
+		    _mm_loadu_si128((const __m128i *)(src + i)));
+		x = _mm256_slli_epi32(x, KMIXER_SIMD_SHIFT16);
+		_mm256_storeu_si256((__m256i *)(bus + i),
+		    kmixer_avx2_adds_epi32(
+		    _mm256_loadu_si256((const __m256i *)(bus + i)), x));
+	}
+	kmixer_simd_scalar.mix_add_s16(bus + i, src + i, n - i);
+}
+
+static AVX2 void
+kmixer_avx2_mix_out_s16(int16_t *dst, const int32_t *bus, u_int n)
+{
+	__m256i a, b;
+	u_int i;
+
+	for (i = 0; i + 16 <= n; i += 16) {
+		a = _mm256_srai_epi32(
+		    _mm256_loadu_si256((const __m256i *)(bus + i)),
+		    KMIXER_SIMD_SHIFT16);
+		b = _mm256_srai_epi32(
+		    _mm256_loadu_si256((const __m256i *)(bus + i + 8)),
+		    KMIXER_SIMD_SHIFT16);
+		_mm256_storeu_si256((__m256i *)(dst + i),
+		    _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b),
+		    _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+	kmixer_simd_scalar.mix_out_s16(dst + i, bus + i, n - i);
+}
+
+/* one xorshift32 step of each lane */
+static inline AVX2 __m256i
+kmixer_avx2_xorshift(__m256i x)
+{
+	x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+	x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+	return _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+}
+
+/* kmixer_tpdf_table entry of each lane, indexed by the top bits of x */
+static inline AVX2 __m256i
+kmixer_avx2_tpdf(__m256i x)
+{
+	__m256i i, w;
+
+	/* gather the 32-bit pair holding each entry, then take its half */
+	i = _mm256_srli_epi32(x, 32 - KMIXER_TPDF_BITS);
+	w = _mm256_i32gather_epi32((const int *)kmixer_tpdf_table,
+	    _mm256_srli_epi32(i, 1), 4);
+	w = _mm256_sllv_epi32(w, _mm256_slli_epi32(
+	    _mm256_andnot_si256(i, _mm256_set1_epi32(1)), 4));
+	return _mm256_srai_epi32(w, 16);
+}
+
+static AVX2 void
+kmixer_avx2_dither_s16(int32_t *bus, u_int n, uint32_t *seed)
+{
+	const __m256i max = _mm256_set1_epi32(KMIXER_BUS_MAX);
+	const __m256i min = _mm256_set1_epi32(KMIXER_BUS_MIN);
+	const __m256i half = _mm256_set1_epi32(1 << (KMIXER_SIMD_SHIFT16 - 1));
+	const __m256i mask = _mm256_set1_epi32(-(1 << KMIXER_SIMD_SHIFT16));
+	__m256i x, v;
+	u_int i;
+
+	x = _mm256_loadu_si256((const __m256i *)seed);
+	for (i = 0; i + 8 <= n; i += 8) {
+		x = kmixer_avx2_xorshift(x);
+		v = _mm256_loadu_si256((const __m256i *)(bus + i));
+		v = _mm256_max_epi32(_mm256_min_epi32(v, max), min);
+		v = _mm256_add_epi32(v, _mm256_add_epi32(half,
+		    _mm256_slli_epi32(kmixer_avx2_tpdf(x),
+		    KMIXER_SIMD_SHIFT16 - 8)));
+		_mm256_storeu_si256((__m256i *)(bus + i),
+		    _mm256_and_si256(v, mask));
+	}
+	_mm256_storeu_si256((__m256i *)seed, x);
+	kmixer_simd_scalar.dither_s16(bus + i, n - i, seed);
+}
+
+static AVX2 void
+kmixer_avx2_dup_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	__m256i x, lo, hi;
+	u_int i;
+
+	for (i = 0; i + 16 <= nframes; i += 16) {
+		x = _mm256_loadu_si256((const __m256i *)(src + i));
+		lo = _mm256_unpacklo_epi16(x, x);
+		hi = _mm256_unpackhi_epi16(x, x);
+		_mm256_storeu_si256((__m256i *)(dst + 2 * i),
+		    _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(dst + 2 * i + 16),
+		    _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	kmixer_simd_scalar.dup_s16(dst + 2 * i, src + i, nframes - i);
+}
+
+/* (l + r) / 2 of each frame, rounded towards zero like C division */
+static inline AVX2 __m256i
+kmixer_avx2_downmix8(__m256i x)
+{
+	__m256i s;
+
+	s = _mm256_madd_epi16(x, _mm256_set1_epi16(1));
+	s = _mm256_add_epi32(s, _mm256_srli_epi32(s, 31));
+	return _mm256_srai_epi32(s, 1);
+}
+
+static AVX2 void
+kmixer_avx2_downmix_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	__m256i a, b;
+	u_int i;
+
+	for (i = 0; i + 16 <= nframes; i += 16) {
+		a = kmixer_avx2_downmix8(
+		    _mm256_loadu_si256((const __m256i *)(src + 2 * i)));
+		b = kmixer_avx2_downmix8(
+		    _mm256_loadu_si256((const __m256i *)(src + 2 * i + 16)));
+		_mm256_storeu_si256((__m256i *)(dst + i),
+		    _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b),
+		    _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+	kmixer_simd_scalar.downmix_s16(dst + i, src + 2 * i, nframes - i);
+}
+
+const struct kmixer_simd_ops kmixer_simd_avx2 = {
+	.name = "avx2",
+	.fpu = true,
+	.mix_add_s16 = kmixer_avx2_mix_add_s16,
+	.mix_out_s16 = kmixer_avx2_mix_out_s16,
+	.dither_s16 = kmixer_avx2_dither_s16,
+	.dup_s16 = kmixer_avx2_dup_s16,
+	.downmix_s16 = kmixer_avx2_downmix_s16,
+};
+
+#endif /* KMIXER_SIMD_X86 */
@@ -0,0 +1,139 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * NEON versions of the kmixer_simd kernels.  NEON has saturating adds
+ * and narrowing shifts, so these map almost one to one onto the scalar
+ * code.
+ */
+
+#include <sys/cdefs.h>
+__KERNEL_RCSID(0, "$NetBSD$");
+
+#include <sys/types.h>
+#include <sys/param.h>
+
+#include <dev/audio_if.h>
+
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+
+#ifdef KMIXER_SIMD_NEON
+
+#include <arm_neon.h>
+
+static void
+kmixer_neon_mix_add_s16(int32_t *bus, const int16_t *src, u_int n)
+{
+	int16x8_t x;
+	u_int i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		x = vld1q_s16(src + i);
+		vst1q_s32(bus + i, vqaddq_s32(vld1q_s32(bus + i),
+		    vshll_n_s16(vget_low_s16(x), KMIXER_SIMD_SHIFT16)));
+		vst1q_s32(bus + i + 4, vqaddq_s32(vld1q_s32(bus + i + 4),
+		    vshll_n_s16(vget_high_s16(x), KMIXER_SIMD_SHIFT16)));
+	}
+	kmixer_simd_scalar.mix_add_s16(bus + i, src + i, n - i);
+}
+
+static void
+kmixer_neon_mix_out_s16(int16_t *dst, const int32_t *bus, u_int n)
+{
+	u_int i;
+
+	/* the saturating narrow clips exactly where the bus would be */
+	for (i = 0; i + 8 <= n; i += 8) {
+		vst1q_s16(dst + i, vcombine_s16(
+		    vqshrn_n_s32(vld1q_s32(bus + i), KMIXER_SIMD_SHIFT16),
+		    vqshrn_n_s32(vld1q_s32(bus + i + 4),
+		    KMIXER_SIMD_SHIFT16)));
+	}
+	kmixer_simd_scalar.mix_out_s16(dst + i, bus + i, n - i);
+}
+
+/*
+ * No vector version: none has been built and checked against the
+ * scalar kernel with kmixer_bench -c on aarch64 yet.
+ */
+static void
+kmixer_neon_dither_s16(int32_t *bus, u_int n, uint32_t *seed)
+{
+	kmixer_simd_scalar.dither_s16(bus, n, seed);
+}
+
+static void
+kmixer_neon_dup_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	int16x8x2_t v;
+	u_int i;
+
+	for (i = 0; i + 8 <= nframes; i += 8) {
+		v.val[0] = v.val[1] = vld1q_s16(src + i);
+		vst2q_s16(dst + 2 * i, v);
+	}
+	kmixer_simd_scalar.dup_s16(dst + 2 * i, src + i, nframes - i);
+}
+
+/* (l + r) / 2 of each frame, rounded towards zero like C division */
+static inline int16x4_t
+kmixer_neon_downmix4(int16x8_t x)
+{
+	int32x4_t s;
+
+	s = vpaddlq_s16(x);
+	s = vaddq_s32(s, vreinterpretq_s32_u32(
+	    vshrq_n_u32(vreinterpretq_u32_s32(s), 31)));
+	return vmovn_s32(vshrq_n_s32(s, 1));
+}
+
+static void
+kmixer_neon_downmix_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	u_int i;
+
+	for (i = 0; i + 8 <= nframes; i += 8) {
+		vst1q_s16(dst + i, vcombine_s16(
+		    kmixer_neon_downmix4(vld1q_s16(src + 2 * i)),
+		    kmixer_neon_downmix4(vld1q_s16(src + 2 * i + 8))));
+	}
+	kmixer_simd_scalar.downmix_s16(dst + i, src + 2 * i, nframes - i);
+}
+
+const struct kmixer_simd_ops kmixer_simd_neon = {
+	.name = "neon",
+	.fpu = true,
+	.mix_add_s16 = kmixer_neon_mix_add_s16,
+	.mix_out_s16 = kmixer_neon_mix_out_s16,
+	.dither_s16 = kmixer_neon_dither_s16,
+	.dup_s16 = kmixer_neon_dup_s16,
+	.downmix_s16 = kmixer_neon_downmix_s16,
+};
+
+#endif /* KMIXER_SIMD_NEON */
@@ -0,0 +1,217 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * SSE2 versions of the kmixer_simd kernels.  The functions carry their
+ * own target attribute so the file builds with the kernel's default
+ * (no SSE) code generation flags.
+ */
+
+#include <sys/cdefs.h>
+__KERNEL_RCSID(0, "$NetBSD$");
+
+#include <sys/types.h>
+#include <sys/param.h>
+
+#include <dev/audio_if.h>
+
+#include "kmixer_mix.h"
+#include "kmixer_simd.h"
+
+#ifdef KMIXER_SIMD_X86
+
+#include <emmintrin.h>
+
+#define SSE2	__attribute__((__target__("sse2")))
+
+/* a + b, saturated to the int32_t range */
+static inline SSE2 __m128i
+kmixer_sse2_adds_epi32(__m128i a, __m128i b)
+{
+	const __m128i max = _mm_set1_epi32(INT32_MAX);
+	__m128i s, ov, sat;
+
+	s = _mm_add_epi32(a, b);
+	/* overflow iff a and b agree in sign and s does not */
+	ov = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(s, a),
+	    _mm_xor_si128(s, b)), 31);
+	sat = _mm_xor_si128(_mm_srai_epi32(a, 31), max);
+	return _mm_or_si128(_mm_and_si128(ov, sat), _mm_andnot_si128(ov, s));
+}
+
+static SSE2 void
+kmixer_sse2_mix_add_s16(int32_t *bus, const int16_t *src, u_int n)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i x, lo, hi;
+	u_int i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		x = _mm_loadu_si128((const __m128i *)(src + i));
+		/* sample in the high half, then arithmetic shift down */
+		lo = _mm_srai_epi32(_mm_unpacklo_epi16(zero, x),
+		    16 - KMIXER_SIMD_SHIFT16);
+		hi = _mm_srai_epi32(_mm_unpackhi_epi16(zero, x),
+		    16 - KMIXER_SIMD_SHIFT16);
+		_mm_storeu_si128((__m128i *)(bus + i), kmixer_sse2_adds_epi32(
+		    _mm_loadu_si128((const __m128i *)(bus + i)), lo));
+		_mm_storeu_si128((__m128i *)(bus + i + 4),
+		    kmixer_sse2_adds_epi32(
+		    _mm_loadu_si128((const __m128i *)(bus + i + 4)), hi));
+	}
+	kmixer_simd_scalar.mix_add_s16(bus + i, src + i, n - i);
+}
+
+static SSE2 void
+kmixer_sse2_mix_out_s16(int16_t *dst, const int32_t *bus, u_int n)
+{
+	__m128i a, b;
+	u_int i;
+
+	/* packs saturates exactly where the bus would be clipped */
+	for (i = 0; i + 8 <= n; i += 8) {
+		a = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(bus + i)),
+		    KMIXER_SIMD_SHIFT16);
+		b = _mm_srai_epi32(
+		    _mm_loadu_si128((const __m128i *)(bus + i + 4)),
+		    KMIXER_SIMD_SHIFT16);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+	}
+	kmixer_simd_scalar.mix_out_s16(dst + i, bus + i, n - i);
+}
+
+/* one xorshift32 step of each lane */
+static inline SSE2 __m128i
+kmixer_sse2_xorshift(__m128i x)
+{
+	x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+	x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+	return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+/* clip v to the bus and round it to 16 bits with the noise of x */
+static inline SSE2 __m128i
+kmixer_sse2_dither4(__m128i v, __m128i x)
+{
+	const __m128i max = _mm_set1_epi32(KMIXER_BUS_MAX);
+	const __m128i min = _mm_set1_epi32(KMIXER_BUS_MIN);
+	uint32_t idx[4];
+	__m128i m, t;
+
+	/* no gather before AVX2, so the lookups are scalar */
+	_mm_storeu_si128((__m128i *)idx,
+	    _mm_srli_epi32(x, 32 - KMIXER_TPDF_BITS));
+	t = _mm_set_epi32(kmixer_tpdf_table[idx[3]],
+	    kmixer_tpdf_table[idx[2]], kmixer_tpdf_table[idx[1]],
+	    kmixer_tpdf_table[idx[0]]);
+
+	m = _mm_cmpgt_epi32(v, max);
+	v = _mm_or_si128(_mm_and_si128(m, max), _mm_andnot_si128(m, v));
+	m = _mm_cmplt_epi32(v, min);
+	v = _mm_or_si128(_mm_and_si128(m, min), _mm_andnot_si128(m, v));
+	v = _mm_add_epi32(v, _mm_add_epi32(
+	    _mm_slli_epi32(t, KMIXER_SIMD_SHIFT16 - 8),
+	    _mm_set1_epi32(1 << (KMIXER_SIMD_SHIFT16 - 1))));
+	return _mm_and_si128(v, _mm_set1_epi32(-(1 << KMIXER_SIMD_SHIFT16)));
+}
+
+static SSE2 void
+kmixer_sse2_dither_s16(int32_t *bus, u_int n, uint32_t *seed)
+{
+	__m128i x0, x1;
+	u_int i;
+
+	x0 = _mm_loadu_si128((const __m128i *)seed);
+	x1 = _mm_loadu_si128((const __m128i *)(seed + 4));
+	for (i = 0; i + 8 <= n; i += 8) {
+		x0 = kmixer_sse2_xorshift(x0);
+		x1 = kmixer_sse2_xorshift(x1);
+		_mm_storeu_si128((__m128i *)(bus + i), kmixer_sse2_dither4(
+		    _mm_loadu_si128((const __m128i *)(bus + i)), x0));
+		_mm_storeu_si128((__m128i *)(bus + i + 4), kmixer_sse2_dither4(
+		    _mm_loadu_si128((const __m128i *)(bus + i + 4)), x1));
+	}
+	_mm_storeu_si128((__m128i *)seed, x0);
+	_mm_storeu_si128((__m128i *)(seed + 4), x1);
+	kmixer_simd_scalar.dither_s16(bus + i, n - i, seed);
+}
+
+static SSE2 void
+kmixer_sse2_dup_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	__m128i x;
+	u_int i;
+
+	for (i = 0; i + 8 <= nframes; i += 8) {
+		x = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + 2 * i),
+		    _mm_unpacklo_epi16(x, x));
+		_mm_storeu_si128((__m128i *)(dst + 2 * i + 8),
+		    _mm_unpackhi_epi16(x, x));
+	}
+	kmixer_simd_scalar.dup_s16(dst + 2 * i, src + i, nframes - i);
+}
+
+/* (l + r) / 2 of each frame, rounded towards zero like C division */
+static inline SSE2 __m128i
+kmixer_sse2_downmix4(__m128i x)
+{
+	__m128i s;
+
+	s = _mm_madd_epi16(x, _mm_set1_epi16(1));
+	s = _mm_add_epi32(s, _mm_srli_epi32(s, 31));
+	return _mm_srai_epi32(s, 1);
+}
+
+static SSE2 void
+kmixer_sse2_downmix_s16(int16_t *dst, const int16_t *src, u_int nframes)
+{
+	__m128i a, b;
+	u_int i;
+
+	for (i = 0; i + 8 <= nframes; i += 8) {
+		a = kmixer_sse2_downmix4(
+		    _mm_loadu_si128((const __m128i *)(src + 2 * i)));
+		b = kmixer_sse2_downmix4(
+		    _mm_loadu_si128((const __m128i *)(src + 2 * i + 8)));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(a, b));
+	}
+	kmixer_simd_scalar.downmix_s16(dst + i, src + 2 * i, nframes - i);
+}
+
+const struct kmixer_simd_ops kmixer_simd_sse2 = {
+	.name = "sse2",
+	.fpu = true,
+	.mix_add_s16 = kmixer_sse2_mix_add_s16,
+	.mix_out_s16 = kmixer_sse2_mix_out_s16,
+	.dither_s16 = kmixer_sse2_dither_s16,
+	.dup_s16 = kmixer_sse2_dup_s16,
+	.downmix_s16 = kmixer_sse2_downmix_s16,
+};
+
+#endif /* KMIXER_SIMD_X86 */
@@ -0,0 +1,132 @@
+/* $NetBSD$ */
+
+/*-
+ * Copyright (c) 2010-2012 Jared D. McNeill <jmcneill@invisible.ca>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE NETBSD FOUNDATION, INC. AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _KMIXERIO_H
+#define _KMIXERIO_H
+
+#include <sys/ioccom.h>
+
+/* sample rate converter quality */
+#define KMIXER_QUALITY_LINEAR	0	/* linear interpolation */
+#define KMIXER_QUALITY_SHORT	1	/* short windowed-sinc FIR */
+#define KMIXER_QUALITY_LONG	2	/* long windowed-sinc FIR */
+
+/*
+ * IEEE 754 single precision samples, full scale +-1.0, precision 32.
+ * The audio(4) API has no float encodings; these are only understood by
+ * kmixer and are chosen well clear of the AUDIO_ENCODING_* values.
+ */
+#define KMIXER_ENCODING_FLOAT_LE	0x1000
+#define KMIXER_ENCODING_FLOAT_BE	0x1001
+
+/*
+ * State of a channel's sample ring, which mmap(2) at offset 0 maps into
+ * the process.  The client stores samples from tail, wrapping at size,
+ * and passes the number of bytes stored to KMIXER_ADVANCE; the mixer
+ * consumes them from head, the oldest sample any of the channel's
+ * devices still has to play.  Changing the channel format with
+ * AUDIO_SETINFO or the ring size with KMIXER_SETBUFSIZE empties the ring
+ * and may change size.
+ */
+struct kmixer_ring {
+	u_int	size;		/* bytes of ring in use, whole frames */
+	u_int	head;		/* offset of the next byte to play */
+	u_int	tail;		/* offset of the next byte to store */
+	u_int	used;		/* bytes queued between head and tail */
+};
+
+#define KMIXER_GETQUALITY	_IOR('K', 1, int)
+#define KMIXER_SETQUALITY	_IOW('K', 2, int)
+#define KMIXER_GETRING		_IOR('K', 3, struct kmixer_ring)
+#define KMIXER_ADVANCE		_IOW('K', 4, u_int)
+/* free bytes at which a writer, poll or kevent is woken, 0 = default */
+#define KMIXER_GETLOWAT		_IOR('K', 5, u_int)
+#define KMIXER_SETLOWAT		_IOW('K', 6, u_int)
+/*
+ * Devices a channel plays on, bit n for audio n, at most
+ * KMIXER_MAXROUTES of them.  0, the default, plays on the preferred
+ * device and follows it across hotplug.  The channel records from the
+ * first of them that is present.
+ */
+#define KMIXER_GETROUTE		_IOR('K', 7, u_int)
+#define KMIXER_SETROUTE		_IOW('K', 8, u_int)
+#define KMIXER_MAXROUTES	4
+/*
+ * Mixer period in microseconds.  A device mixes at the shortest period
+ * its channels and hw.kmixer.period ask for, never below
+ * KMIXER_MINPERIOD; 0 asks for nothing.  GETPERIOD returns the period of
+ * the device the channel records from.
+ */
+#define KMIXER_GETPERIOD	_IOR('K', 9, u_int)
+#define KMIXER_SETPERIOD	_IOW('K', 10, u_int)
+#define KMIXER_MINPERIOD	2000
+/*
+ * Size in bytes of both rings of a channel, rounded to whole frames;
+ * 0 takes hw.kmixer.bufsize.  Setting it empties the rings.
+ */
+#define KMIXER_GETBUFSIZE	_IOR('K', 11, u_int)
+#define KMIXER_SETBUFSIZE	_IOW('K', 12, u_int)
+
+/*
+ * Latency histograms.  Bucket n counts times of 2^n to 2^(n+1)
+ * microseconds; the first bucket also takes anything shorter and the
+ * last anything longer.  lat is sampled: one write or KMIXER_ADVANCE at
+ * a time is timed from being queued until the block holding its last
+ * sample has been written to the device.  mix is the time taken to mix
+ * each period on the device the channel records from.
+ */
+#define KMIXER_LATBUCKETS	20
+
+struct kmixer_latency {
+	uint64_t	lat[KMIXER_LATBUCKETS];
+	uint64_t	mix[KMIXER_LATBUCKETS];
+};
+
+#define KMIXER_GETLATENCY	_IOR('K', 13, struct kmixer_latency)
+
+/*
+ * Channel volume, applied as the channel is mixed.  gain is fixed point,
+ * KMIXER_GAIN_UNITY leaves samples as they are.  pan moves a stereo
+ * channel left (negative) or right by attenuating the other side, and
+ * is ignored for other channel counts.  mute silences the channel
+ * keeping its gain.  Changes are ramped over a few milliseconds.
+ */
+#define KMIXER_GAIN_UNITY	0x10000
+#define KMIXER_GAIN_MAX		(4 * KMIXER_GAIN_UNITY)
+#define KMIXER_PAN_MAX		0x10000
+
+struct kmixer_gain {
+	u_int		gain;		/* 0 .. KMIXER_GAIN_MAX */
+	int		pan;		/* -KMIXER_PAN_MAX .. KMIXER_PAN_MAX */
+	int		mute;
+};
+
+#define KMIXER_GETGAIN		_IOR('K', 14, struct kmixer_gain)
+#define KMIXER_SETGAIN		_IOW('K', 15, struct kmixer_gain)
+
+#endif /* !_KMIXERIO_H */
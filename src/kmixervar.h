@@ -35,23 +35,230 @@ struct kmixer_ch;
 
 TAILQ_HEAD(kmixer_hw_list, kmixer_hw);
 TAILQ_HEAD(kmixer_ch_list, kmixer_ch);
+TAILQ_HEAD(kmixer_pgroup_list, kmixer_pgroup);
+TAILQ_HEAD(kmixer_rgroup_list, kmixer_rgroup);
+TAILQ_HEAD(kmixer_route_list, kmixer_route);
 
-/* hardware state */
+/*
+ * A channel playing on one device.  Every device consumes the channel
+ * ring at its own head, see kmixer_chan_head().
+ */
+struct kmixer_route {
+	struct kmixer_ch	*rt_ch;
+	struct kmixer_hw	*rt_hw;		/* NULL if the slot is free */
+	struct kmixer_pgroup	*rt_pgroup;
+	volatile u_int		rt_head;	/* advanced by rt_hw's mixer */
+	volatile bool		rt_silent;	/* rt_hw refused the format */
+
+	/* counters, under rt_hw's hw_lock, see kmixer_sysctl_route() */
+	uint64_t		rt_frames;	/* frames mixed */
+	uint64_t		rt_cvtframes;	/* of which resampled */
+	uint64_t		rt_underruns;	/* times the ring ran dry */
+	uint64_t		rt_cycles;	/* spent summing the ring */
+	size_t			rt_got;		/* frames this pass */
+	bool			rt_dry;		/* empty since last underrun */
+	bool			rt_latmark;	/* mixed ch_latpos this period */
+	struct kmixer_ramp	rt_ramp;	/* ch_gain, owned by the mixer */
+
+	TAILQ_ENTRY(kmixer_route) rt_pgentry;
+	TAILQ_ENTRY(kmixer_route) rt_entry;
+};
+
+/*
+ * A play format shared by one or more channels on a device.  Each period
+ * the channels' samples are summed on a bus at their own rate, and the
+ * sum is resampled once to the hardware rate and channels.
+ */
+struct kmixer_pgroup {
+	struct kmixer_hw	*pg_hw;
+	struct kmixer_route_list pg_rt;		/* channels in the group */
+	audio_params_t		pg_params;	/* client play format */
+	int			pg_quality;	/* KMIXER_QUALITY_* */
+	bool			pg_direct;	/* no resampling, sum to hw */
+	bool			pg_steer;	/* follows the device's clock */
+	bool			pg_native;	/* direct, in the hardware format */
+
+	/* bus samples at pg_params' rate and channels, see pg_sparams */
+	int32_t			*pg_sum;
+	audio_params_t		pg_sparams;
+
+	/* bus samples at the hardware rate and channels, owned by mixer */
+	audio_params_t		pg_cparams;
+	struct kmixer_samplerate_context pg_ctx;
+	uint8_t			*pg_cvtbuf;
+	size_t			pg_cvtlen;
+
+	TAILQ_ENTRY(kmixer_pgroup) pg_entry;
+};
+
+/*
+ * A record format wanted by one or more channels on a device.  Each
+ * captured block is converted once per group and then copied to the
+ * rings of all the channels in it.
+ */
+struct kmixer_rgroup {
+	struct kmixer_hw	*rg_hw;
+	struct kmixer_ch_list	rg_ch;		/* channels in the group */
+	audio_params_t		rg_params;	/* client record format */
+	int			rg_quality;	/* KMIXER_QUALITY_* */
+	bool			rg_steer;	/* follows the device's clock */
+
+	/* client rate and channels, still in the hardware encoding */
+	audio_params_t		rg_cparams;
+	struct kmixer_samplerate_context rg_ctx;
+	uint8_t			*rg_cvtbuf;
+	size_t			rg_cvtsize;
+
+	/* the last block in rg_params, rg_cvtbuf if no recoding needed */
+	int32_t			*rg_bus;
+	uint8_t			*rg_buf;
+	size_t			rg_bufsize;
+	size_t			rg_len;
+
+	TAILQ_ENTRY(kmixer_rgroup) rg_entry;
+};
+
+/*
+ * Rate a device really runs at, from a delay-locked loop on the times
+ * its periods complete, see kmixer_clock_update().
+ */
+struct kmixer_clock {
+	uint64_t		ck_next;	/* predicted end of period, ns */
+	int64_t			ck_period;	/* filtered, ns << 16 */
+	int64_t			ck_nominal;	/* ns << 16 */
+	int64_t			ck_b;		/* loop gains, Q32 */
+	int64_t			ck_c;
+	size_t			ck_frames;	/* per period, 0 = unlocked */
+	int32_t			ck_drift;	/* rate / nominal - 1, Q32 */
+};
+
+/*
+ * hardware state
+ *
+ * The mixer and capture threads of a device hold only hw_lock, so
+ * devices mix in parallel.  The group and route lists, and the flags
+ * the threads wait on, change with both sc_lock and hw_lock held and
+ * may be read with either.
+ */
 struct kmixer_hw {
 	device_t		hw_dev;
 	dev_t			hw_audiodev;
-	struct kmixer_ch_list	hw_act_ch;	/* active channel list */
+	struct kmixer_route_list hw_routes;	/* channels playing here */
 	TAILQ_ENTRY(kmixer_hw)	hw_entry;
+
+	struct kmixer_softc	*hw_softc;
+	kmutex_t		hw_lock;
+	kcondvar_t		hw_cv;		/* under hw_lock */
+	lwp_t			*hw_thread;	/* mixer thread */
+	lwp_t			*hw_rthread;	/* capture thread */
+	bool			hw_open;	/* audio device is open */
+	bool			hw_opening;	/* open or SETINFO sleeping */
+	bool			hw_busy;	/* mixer is writing a block */
+	bool			hw_rbusy;	/* capture is reading a block */
+	bool			hw_dying;	/* threads should exit */
+	bool			hw_suspended;	/* see kmixer_hw_suspend() */
+
+	u_int			hw_encs;	/* native, see kmixer_enc_bit() */
+	audio_params_t		hw_badfmt;	/* format the driver refused */
+	audio_params_t		hw_pparams;	/* play format */
+	size_t			hw_blksize;	/* bytes per mixer period */
+	u_int			hw_period;	/* microseconds, 0 = driver's */
+	u_int			hw_defblksize;	/* driver's, at open */
+	u_int			hw_defhiwat;
+	int32_t			*hw_mixbuf;	/* mix bus, one period */
+	uint8_t			*hw_outbuf;	/* one period in hw_pparams */
+	struct kmixer_dither	hw_dither;	/* owned by the mixer */
+	struct kmixer_pgroup_list hw_pgroups;	/* formats being played */
+	struct kmixer_clock	hw_pclock;	/* under hw_lock */
+	bool			hw_played;	/* a route took samples */
+	u_int			hw_idle;	/* microseconds since one did */
+
+	audio_params_t		hw_rparams;	/* record format */
+	uint8_t			*hw_inbuf;	/* one period in hw_rparams */
+	struct kmixer_rgroup_list hw_rgroups;	/* formats being recorded */
+	struct kmixer_clock	hw_rclock;	/* under hw_lock */
+
+	/* counters, under hw_lock */
+	char			hw_evgroup[32];
+	struct evcnt		hw_ev_frames;	/* frames written */
+	struct evcnt		hw_ev_underruns; /* channels run dry */
+	struct evcnt		hw_ev_late;	/* periods mixed too slowly */
+	struct evcnt		hw_ev_mixcycles;
+	struct evcnt		hw_ev_cvtcycles; /* resampling, recoding */
+	struct evcnt		hw_ev_recframes; /* frames read */
+	struct evcnt		hw_ev_overruns;	/* channels losing samples */
+	struct evcnt		hw_ev_suspends;	/* paused while idle */
+	uint64_t		hw_mixhist[KMIXER_LATBUCKETS];
+	u_int			hw_latmarks;	/* routes with rt_latmark */
 };
 
 /* channel state */
 struct kmixer_ch {
 	kmutex_t		ch_lock;
 	kcondvar_t		ch_cv;
+	kmutex_t		ch_wlock;	/* serialises writers */
 	struct kmixer_softc	*ch_softc;
-	struct kmixer_hw	*ch_selhw;
+	int			ch_mode;	/* AUMODE_* from open flags */
+
+	/* the devices playing the channel, under sc_lock */
+	u_int			ch_route;	/* KMIXER_SETROUTE */
+	volatile u_int		ch_rtmask;	/* ch_rt slots in use */
+	struct kmixer_route	ch_rt[KMIXER_MAXROUTES];
 
 	audio_params_t		ch_pparams;
+	bool			ch_mixable;	/* ch_pparams is supported */
+	int			ch_quality;	/* KMIXER_QUALITY_* */
+	struct kmixer_gain	ch_gainreq;	/* KMIXER_SETGAIN, under ch_wlock */
+	volatile int32_t	ch_gain[3];	/* left, right, unpanned */
+	volatile u_int		ch_gaingen;	/* odd while ch_gain changes */
+
+	/* client samples in ch_pparams, see kmixer_ring_used() */
+	uint8_t			*ch_buf;
+	struct uvm_object	*ch_uobj;	/* backs ch_buf, for mmap */
+	bool			ch_mapped;	/* ch_buf mapped by a process */
+	size_t			ch_bufsize;	/* whole frames of ch_buf */
+	size_t			ch_lowat;	/* free space to wake writer */
+	size_t			ch_lowatreq;	/* KMIXER_SETLOWAT, 0 = default */
+	size_t			ch_bufreq;	/* KMIXER_SETBUFSIZE, 0 = default */
+	u_int			ch_periodreq;	/* KMIXER_SETPERIOD, under sc_lock */
+	volatile u_int		ch_rhead;	/* head while no route plays */
+	volatile u_int		ch_rtail;	/* advanced by the writer */
+	volatile bool		ch_wwait;	/* writer sleeps on ch_cv */
+	uint64_t		ch_wframes;	/* under ch_wlock */
+	uint64_t		ch_wblocked;	/* writes slept, under ch_wlock */
+
+	/* one queued sample being timed, see kmixer_lat_arm() */
+	volatile u_int		ch_latstate;	/* KMIXER_LAT_* */
+	u_int			ch_latpos;	/* ring index past the sample */
+	uint64_t		ch_latenq;	/* nanouptime when queued */
+	uint64_t		ch_lathist[KMIXER_LATBUCKETS];
+
+	/* poll and kqueue waiters for ch_lowat, under ch_lock */
+	struct selinfo		ch_wsel;
+	volatile bool		ch_pwait;	/* poller recorded on ch_wsel */
+	volatile u_int		ch_nknotes;	/* knotes on ch_wsel */
+
+	/* recorded samples in ch_recparams, filled by the capture thread */
+	kmutex_t		ch_reclock;	/* serialises readers */
+	audio_params_t		ch_recparams;
+	bool			ch_recok;	/* ch_recparams is supported */
+	struct kmixer_rgroup	*ch_recgroup;
+	TAILQ_ENTRY(kmixer_ch)	ch_recentry;
+	uint8_t			*ch_recbuf;
+	size_t			ch_recsize;	/* whole frames of ch_recbuf */
+	volatile u_int		ch_rechead;	/* advanced by the reader */
+	volatile u_int		ch_rectail;	/* advanced by the capture */
+	volatile bool		ch_recwait;	/* reader sleeps on ch_cv */
+	struct selinfo		ch_recsel;	/* under ch_lock */
+	volatile bool		ch_recpwait;	/* poller recorded on ch_recsel */
+	volatile u_int		ch_recnknotes;	/* knotes on ch_recsel */
+	uint64_t		ch_recframes;	/* by the capture thread */
+	uint64_t		ch_overruns;	/* blocks not fully queued */
+
+	/* hw.kmixer.ch<serial>, see kmixer_chan_sysctl_setup() */
+	struct sysctllog	*ch_sysctllog;
+	u_int			ch_serial;
+	int			ch_pid;
 
 	TAILQ_ENTRY(kmixer_ch) ch_entry;
 };
@@ -63,10 +270,28 @@ struct kmixer_softc {
 
 	struct kmixer_hw_list	sc_hw;		/* hardware list */
 	struct kmixer_hw	*sc_selhw;	/* selected hw device */
+	struct kmixer_hw_list	sc_dead_hw;	/* removed, awaiting join */
 
-	struct kmixer_ch_list	sc_inact_ch;	/* inactive channel list */
+	struct kmixer_ch_list	sc_ch;		/* open channels */
+	pool_cache_t		sc_chcache;	/* struct kmixer_ch */
 
 	void			*sc_hook;	/* devicehook handle */
+	lwp_t			*sc_mthread;	/* channel migration */
+	bool			sc_migrate;	/* sc_mthread has work */
+	bool			sc_dying;	/* sc_mthread should exit */
+	u_int			sc_hwgen;	/* sc_hw changes */
+
+	struct sysctllog	*sc_sysctllog;
+	const struct sysctlnode	*sc_sysctlnode;	/* hw.kmixer */
+	u_int			sc_chserial;	/* next ch_serial */
+	u_int			sc_period;	/* hw.kmixer.period */
+	u_int			sc_bufsize;	/* hw.kmixer.bufsize */
+	u_int			sc_drift;	/* hw.kmixer.drift */
+	u_int			sc_rate;	/* hw.kmixer.rate */
+	u_int			sc_idle;	/* hw.kmixer.idle, read unlocked */
+	u_int			sc_dither;	/* hw.kmixer.dither, unlocked */
+	u_int			sc_nodither;	/* hw.kmixer.nodither, unlocked */
+	volatile u_int		sc_nsuspended;	/* devices suspended */
 
 	struct audio_softc	sc_audiosc;	/* fake audio softc */
 };